@@ -314,11 +314,11 @@ void bcalm2(Storage *storage,
 
     u_int64_t rg = ((u_int64_t)1 << (2*minSize));
 
-    /* Retrieve frequency of minimizers;
+    /* Retrieve frequency (or other order) of minimizers;
      * actually only used in minimizerMin and minimizerMax */
     uint32_t *freq_order = NULL;
 
-    if (minimizer_type == 1)
+    if (minimizer_type != 0)
     {
         freq_order = new uint32_t[rg];
         Storage::istream is (minimizersGroup, "minimFrequency");
@@ -851,7 +851,7 @@ void bcalm2(Storage *storage,
     }
 
     // cleanup everything that was new'd
-    if (minimizer_type == 1)
+    if (minimizer_type != 0)
         delete[] freq_order;
     delete[] nb_seqs_in_glue;
     delete[] nb_pretips;
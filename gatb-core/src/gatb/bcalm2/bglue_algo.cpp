@@ -520,6 +520,89 @@ class hasher_t
     }
 };
     
+/* streams the UF hashes of several ".glue.hashes.<pass>" files, one after the other,
+ * so that BooPHF can be constructed without loading all the hashes in memory.
+ * (BooPHF calls begin() once per level, each time the files are re-read from the start) */
+class uf_hashes_files_range
+{
+    std::vector<std::string> filenames;
+
+    public:
+    class iterator : public std::iterator<std::forward_iterator_tag, const uf_hashes_t>
+    {
+        struct state_t
+        {
+            const std::vector<std::string> *filenames;
+            unsigned int file_idx;
+            FILE *handle;
+            std::vector<uf_hashes_t> buffer;
+            size_t buffer_pos, buffer_size;
+            uint64_t pos;
+
+            ~state_t() { if (handle) fclose(handle); }
+        };
+        std::shared_ptr<state_t> state; // null means end()
+
+        void refill()
+        {
+            state->buffer_pos = 0;
+            state->buffer_size = 0;
+            while (state->buffer_size == 0)
+            {
+                if (state->handle == nullptr)
+                {
+                    if (state->file_idx >= state->filenames->size()) { state.reset(); return; }
+                    state->handle = fopen((*state->filenames)[state->file_idx].c_str(), "rb");
+                    if (!state->handle) { std::cout << "error opening " << (*state->filenames)[state->file_idx] << " for reading." << std::endl; exit(1);}
+                }
+                state->buffer_size = fread(state->buffer.data(), sizeof(uf_hashes_t), state->buffer.size(), state->handle);
+                if (state->buffer_size == 0)
+                {
+                    fclose(state->handle);
+                    state->handle = nullptr;
+                    state->file_idx++;
+                }
+            }
+        }
+
+        public:
+        iterator() {}
+
+        iterator(const std::vector<std::string> &filenames) : state(std::make_shared<state_t>())
+        {
+            state->filenames = &filenames;
+            state->file_idx = 0;
+            state->handle = nullptr;
+            state->buffer.resize(1 << 16);
+            state->pos = 0;
+            refill();
+        }
+
+        uf_hashes_t const& operator*() const { return state->buffer[state->buffer_pos]; }
+
+        iterator& operator++()
+        {
+            state->pos++;
+            if (++state->buffer_pos == state->buffer_size)
+                refill();
+            return *this;
+        }
+
+        friend bool operator==(iterator const& lhs, iterator const& rhs)
+        {
+            if (!lhs.state || !rhs.state) return (!lhs.state && !rhs.state);
+            return lhs.state->pos == rhs.state->pos;
+        }
+
+        friend bool operator!=(iterator const& lhs, iterator const& rhs) { return !(lhs == rhs); }
+    };
+
+    uf_hashes_files_range(const std::vector<std::string> &filenames) : filenames(filenames) {}
+
+    iterator begin() const { return iterator(filenames); }
+    iterator end  () const { return iterator(); }
+};
+
 /* computes and uniquifies the hashes of marked kmers at extremities of all to-be-glued sequences */
 template <int SPAN>
 void prepare_uf(std::string prefix, IBank *in, const int nb_threads, int& kmerSize, int pass, int nb_passes, uint64_t &nb_elts, uint64_t estimated_nb_glue_sequences)
@@ -715,7 +798,8 @@ void bglue(Storage *storage,
         int nb_glue_partitions, 
         int nb_threads, 
         bool all_abundance_counts,
-        bool verbose
+        bool verbose,
+        int max_memory
         )
 {
     auto start_t=chrono::system_clock::now();
@@ -777,35 +861,66 @@ void bglue(Storage *storage,
     /*
      * puts all the uf hashes in disk.
      */
+    // each pass holds the hashes of 2*nb_glue_sequences/nb_passes extremities in memory,
+    // so when a memory budget is given, use as many passes as needed to fit in it
+    uint64_t max_memory_bytes = (uint64_t)std::max(max_memory, 0) * 1024ULL * 1024ULL;
     int nb_prepare_passes = 3;
+    if (max_memory_bytes > 0)
+    {
+        uint64_t prepare_memory = 2 * nb_glue_sequences * sizeof(uf_hashes_t);
+        nb_prepare_passes = std::max((uint64_t)nb_prepare_passes, (prepare_memory + max_memory_bytes - 1) / max_memory_bytes);
+        logging("using " + to_string(nb_prepare_passes) + " passes to prepare UF hashes within " + to_string(max_memory) + " MB");
+    }
+
     uint64_t nb_elts = 0;
     for (int pass = 0; pass < nb_prepare_passes; pass++)
         prepare_uf<SPAN>(prefix, in, nb_threads, kmerSize, pass, nb_prepare_passes, nb_elts, nb_glue_sequences);
 
-    // load uf hashes from disk
-    std::vector<uf_hashes_t> uf_hashes;
-    uf_hashes.reserve(nb_elts);
-    for (int pass = 0; pass < nb_prepare_passes; pass++)
+    // the in-memory mode loads all hashes (8 bytes/key) to construct the MPHF, then uses a 64-bits UF (8 bytes/key).
+    // the memory-bounded mode streams the hashes from disk to construct the MPHF, and uses a 32-bits UF (4 bytes/key)
+    // which is, once flattened, directly the vector of UF classes used later on (so, no mirroring of the UF either).
+    uint64_t inram_uf_memory = std::max(nb_elts, (uint64_t)1) * (sizeof(uf_hashes_t) + sizeof(std::atomic<uint64_t>));
+    bool bounded_uf = (max_memory_bytes > 0) && (inram_uf_memory > max_memory_bytes);
+
+    int gamma = 3; // make it even faster.
+
+    typedef boomphf::mphf<uf_hashes_t, /*TODO we don't need hasher_t here now that we're not hashing kmers, but I forgot to change*/ hasher_t< uf_hashes_t> > uf_mphf_t;
+    uf_mphf_t uf_mphf;
+    unsigned long nb_uf_keys = 0;
+
+    if (bounded_uf && nb_elts > 0)
     {
-        IteratorFile<uf_hashes_t> file(prefix+".glue.hashes." + to_string(pass));
-        for (file.first(); !file.isDone(); file.next())
-            uf_hashes.push_back(file.item());
+        logging("in-memory UF would need " + to_string(inram_uf_memory/1024/1024) + " MB, above max memory; constructing UF MPHF from disk");
+
+        std::vector<std::string> hashes_files;
+        for (int pass = 0; pass < nb_prepare_passes; pass++)
+            hashes_files.push_back(prefix+".glue.hashes." + to_string(pass));
+
+        nb_uf_keys = nb_elts;
+        uf_hashes_files_range uf_hashes_range(hashes_files);
+        uf_mphf = uf_mphf_t(nb_uf_keys, uf_hashes_range, nb_threads, gamma, verbose);
     }
-    if (uf_hashes.size() == 0) // prevent an edge case when there's nothing to glue, boophf doesn't like it
-        uf_hashes.push_back(0);
+    else
+    {
+        // load uf hashes from disk
+        std::vector<uf_hashes_t> uf_hashes;
+        uf_hashes.reserve(nb_elts);
+        for (int pass = 0; pass < nb_prepare_passes; pass++)
+        {
+            IteratorFile<uf_hashes_t> file(prefix+".glue.hashes." + to_string(pass));
+            for (file.first(); !file.isDone(); file.next())
+                uf_hashes.push_back(file.item());
+        }
+        if (uf_hashes.size() == 0) // prevent an edge case when there's nothing to glue, boophf doesn't like it
+            uf_hashes.push_back(0);
 
-    unsigned long nb_uf_keys = uf_hashes.size();
-    logging("loaded all unique UF elements (" + std::to_string(nb_uf_keys) + ") into a single vector of size " + to_string(nb_uf_keys* sizeof(uf_hashes_t) / 1024/1024) + " MB");
+        nb_uf_keys = uf_hashes.size();
+        logging("loaded all unique UF elements (" + std::to_string(nb_uf_keys) + ") into a single vector of size " + to_string(nb_uf_keys* sizeof(uf_hashes_t) / 1024/1024) + " MB");
 
-    int gamma = 3; // make it even faster.
- 
-    // side question:
-    // why not iterate the UF hashes from disk instead of loading them in memory (to construt that mphf)?
-    // I believe it's because the UF will anyway be loaded in memory after and will also take as much space as those hashes
-    
-    boomphf::mphf<uf_hashes_t, /*TODO we don't need hasher_t here now that we're not hashing kmers, but I forgot to change*/ hasher_t< uf_hashes_t> > uf_mphf(nb_uf_keys, uf_hashes, nb_threads, gamma, verbose);
+        uf_mphf = uf_mphf_t(nb_uf_keys, uf_hashes, nb_threads, gamma, verbose);
 
-    free_memory_vector(uf_hashes);
+        free_memory_vector(uf_hashes);
+    }
 
     if (verbose)
     {
@@ -821,7 +936,9 @@ void bglue(Storage *storage,
 
     // create a UF data structure
     // this one stores nb_uf_keys * uint64_t (actually, atomic's).
-    unionFind ufkmers(nb_uf_keys);
+    unionFind ufkmers(bounded_uf ? 0 : nb_uf_keys);
+    // and this one nb_uf_keys * uint32_t, only used in memory-bounded mode
+    unionFindCompact ufkmers_compact(bounded_uf ? nb_uf_keys : 0);
 
 #if 0
     unionFind<unsigned int> ufmin;
@@ -845,7 +962,7 @@ void bglue(Storage *storage,
     */
     
     auto createUF = [k, &modelCanon, \
-        &uf_mphf, &ufkmers, &hasher](const Sequence& sequence)
+        &uf_mphf, &ufkmers, &ufkmers_compact, bounded_uf, &hasher](const Sequence& sequence)
     {
         const string seq = sequence.toString();
         const string comment = sequence.getComment();
@@ -871,7 +988,10 @@ void bglue(Storage *storage,
         uint32_t v1 = uf_mphf.lookup(hasher(kmmerBegin));
         uint32_t v2 = uf_mphf.lookup(hasher(kmmerEnd));
 
-        ufkmers.union_(v1,v2);
+        if (bounded_uf)
+            ufkmers_compact.union_(v1,v2);
+        else
+            ufkmers.union_(v1,v2);
         //ufkmers.union_((hasher(kmmerBegin)), (hasher(kmmerEnd)));
 
 #if 0
@@ -917,7 +1037,7 @@ void bglue(Storage *storage,
         System::file().remove (prefix+".glue.hashes." + to_string(pass));
 
 
-    if (debug_uf_stats) // for debugging
+    if (debug_uf_stats && !bounded_uf) // for debugging
     {
         ufkmers.printStats("uf kmers");
         //ufkmers.dump("uf.dump");
@@ -927,33 +1047,44 @@ void bglue(Storage *storage,
     if (only_uf) // for debugging
         return;
 
-    /* now we're mirroring the UF to a vector of uint32_t's (uf_class_t), it will take less space, and strictly same information
-     * this is to get rid of the rank (one uint32) per element in the current UF implementation. 
-     * To do this, we're using the disk to save space of populating one vector from the other in memory. 
-     * (saves having to allocate both vectors at the same time) */
-    
-    BagFile<uf_class_t> *ufkmers_bagf = new BagFile<uf_class_t>(prefix+".glue.uf");  LOCAL(ufkmers_bagf);
-	BagCache<uf_class_t> *ufkmers_bag = new BagCache<uf_class_t>(  ufkmers_bagf, 10000 );   LOCAL(ufkmers_bag);
+    std::vector<uf_class_t> ufkmers_vector;
+
+    if (bounded_uf)
+    {
+        // the compact UF already is a vector of uint32_t's, just make each element point to its class
+        ufkmers_compact.flatten();
+        ufkmers_vector.swap(ufkmers_compact.mData);
+    }
+    else
+    {
+        /* now we're mirroring the UF to a vector of uint32_t's (uf_class_t), it will take less space, and strictly same information
+         * this is to get rid of the rank (one uint32) per element in the current UF implementation. 
+         * To do this, we're using the disk to save space of populating one vector from the other in memory. 
+         * (saves having to allocate both vectors at the same time) */
 
-    for (unsigned long i = 0; i < nb_uf_keys; i++)
-        //ufkmers_vector[i] = ufkmers.find(i); // just in-memory without the disk
-        ufkmers_bag->insert(ufkmers.find(i));
+        BagFile<uf_class_t> *ufkmers_bagf = new BagFile<uf_class_t>(prefix+".glue.uf");  LOCAL(ufkmers_bagf);
+        BagCache<uf_class_t> *ufkmers_bag = new BagCache<uf_class_t>(  ufkmers_bagf, 10000 );   LOCAL(ufkmers_bag);
 
-    uint64_t size_mdata = sizeof(std::atomic<uint64_t>) * ufkmers.mData.size();
-    free_memory_vector(ufkmers.mData);
+        for (unsigned long i = 0; i < nb_uf_keys; i++)
+            //ufkmers_vector[i] = ufkmers.find(i); // just in-memory without the disk
+            ufkmers_bag->insert(ufkmers.find(i));
 
-    logging("freed original UF (" + to_string(size_mdata/1024/1024) + " MB)");
+        uint64_t size_mdata = sizeof(std::atomic<uint64_t>) * ufkmers.mData.size();
+        free_memory_vector(ufkmers.mData);
 
-    ufkmers_bag->flush();
+        logging("freed original UF (" + to_string(size_mdata/1024/1024) + " MB)");
 
-    std::vector<uf_class_t> ufkmers_vector(nb_uf_keys);
-    IteratorFile<uf_class_t> ufkmers_file(prefix+".glue.uf");
-    unsigned long i = 0;
-    for (ufkmers_file.first(); !ufkmers_file.isDone(); ufkmers_file.next())
-            ufkmers_vector[i++] = ufkmers_file.item();
+        ufkmers_bag->flush();
+
+        ufkmers_vector.resize(nb_uf_keys);
+        IteratorFile<uf_class_t> ufkmers_file(prefix+".glue.uf");
+        unsigned long i = 0;
+        for (ufkmers_file.first(); !ufkmers_file.isDone(); ufkmers_file.next())
+                ufkmers_vector[i++] = ufkmers_file.item();
+
+        System::file().remove (prefix+".glue.uf");
+    }
 
-    System::file().remove (prefix+".glue.uf");
-    
     logging("loaded 32-bit UF (" + to_string(nb_uf_keys*sizeof(uf_class_t)/1024/1024) + " MB)");
   
     // setup output file
@@ -995,8 +1126,8 @@ void bglue(Storage *storage,
             return ufclass;
         };
 
-    std::mutex outLock; // for the main output file
-    std::vector<BufferedFasta*> gluePartitions(nbGluePartitions);
+    std::mutex outLock; // for printing from the glueing threads
+    std::vector<BufferedGluePartition*> gluePartitions(nbGluePartitions);
     std::string gluePartition_prefix = output_prefix + ".gluePartition.";
     unsigned int max_buffer = 50000;
     std::vector<std::atomic<unsigned long>> nb_seqs_in_partition(nbGluePartitions);
@@ -1007,7 +1138,7 @@ void bglue(Storage *storage,
         string filename = gluePartition_prefix + std::to_string(i);
         if (System::file().doesExist(filename))
            System::file().remove (filename);
-        gluePartitions[i] = new BufferedFasta(filename, max_buffer);
+        gluePartitions[i] = new BufferedGluePartition(filename, max_buffer);
         nb_seqs_in_partition[i] = 0;
     }
 
@@ -1017,7 +1148,7 @@ void bglue(Storage *storage,
     // partition the glue into many files, à la dsk
     auto partitionGlue = [k, &modelCanon /* crashes if copied!*/, \
         &get_UFclass, &gluePartitions, all_abundance_counts,
-        &out, &outLock, &nb_seqs_in_partition, nbGluePartitions]
+        &out, &nb_seqs_in_partition, nbGluePartitions]
             (const Sequence& sequence)
     {
         const string &seq = sequence.toString();
@@ -1049,7 +1180,7 @@ void bglue(Storage *storage,
         //stringstream ss1; // to save partition later in the comment. [why? probably to avoid recomputing it]
         //ss1 << blabla;
 
-        output(seq, *gluePartitions[index], comment);
+        gluePartitions[index]->insert(seq, comment);
         nb_seqs_in_partition[index]++;
     };
 
@@ -1069,8 +1200,8 @@ void bglue(Storage *storage,
 
     logging("Done disk partitioning of glue");
 
-    // get top10 largest glue partitions
-    int top_n_glue_partition = std::min(10,nbGluePartitions);
+    // order glue partitions by decreasing size: they are enqueued in that order in the thread pool,
+    // so that the largest ones start first and the small ones fill the gaps at the end
     vector<unsigned long> vx, copy_nb_seqs_in_partition;
     vx.resize(nb_seqs_in_partition.size());
     copy_nb_seqs_in_partition.resize(nb_seqs_in_partition.size());
@@ -1079,10 +1210,11 @@ void bglue(Storage *storage,
         vx[i]= i;
         copy_nb_seqs_in_partition[i] = nb_seqs_in_partition[i]; // to get rid of atomic type
     }
-    partial_sort( vx.begin(), vx.begin()+top_n_glue_partition, vx.end(), Comp<unsigned long>(copy_nb_seqs_in_partition) );
+    stable_sort( vx.begin(), vx.end(), Comp<unsigned long>(copy_nb_seqs_in_partition) );
 
     if (verbose)
     {
+        int top_n_glue_partition = std::min(10,nbGluePartitions);
         std::cout << "Top 10 glue partitions by size:" << std::endl;
         for (int i = 0; i < top_n_glue_partition; i++)
             std::cout << "Glue partition " << vx[i] << " has " << copy_nb_seqs_in_partition[vx[i]] << " sequences " << endl;
@@ -1090,18 +1222,29 @@ void bglue(Storage *storage,
 
     logging("Glueing partitions");
 
+    // each thread of the pool writes glued sequences to its own output shard, without locking;
+    // shards are appended to the main output at the end (which is where consecutive ids are given)
+    std::vector<BufferedFasta*> outShards(nb_threads);
+    std::string outShard_prefix = output_prefix + ".glueOut.";
+    for (int i = 0; i < nb_threads; i++)
+    {
+        outShards[i] = new BufferedFasta(outShard_prefix + std::to_string(i), 100000);
+        outShards[i]->threadsafe = false;
+    }
+
     // glue all partitions using a thread pool
     ThreadPool pool(nb_threads);
-    for (int partition = 0; partition < nbGluePartitions; partition++)
+    for (int vx_idx = 0; vx_idx < nbGluePartitions; vx_idx++)
     {
+        int partition = vx[vx_idx];
         auto glue_partition = [&modelCanon, &ufkmers, partition, &gluePartition_prefix, nbGluePartitions, &copy_nb_seqs_in_partition,
-        &get_UFclass, &out, &outLock, kmerSize, all_abundance_counts]( int thread_id)
+        &get_UFclass, &outShards, &outLock, kmerSize, all_abundance_counts]( int thread_id)
         {
             int k = kmerSize;
 
             string partitionFile = gluePartition_prefix + std::to_string(partition);
-            BankFasta partitionBank (partitionFile); // BankFasta
-            BankFasta::Iterator it (partitionBank); // BankFasta
+            GluePartitionIterator it (partitionFile);
+            BufferedFasta &out = *outShards[thread_id];
 
             outLock.lock(); // should use a printlock..
             if (partition % 20 == 0) // sparse printing
@@ -1114,11 +1257,9 @@ void bglue(Storage *storage,
             unordered_map<int, vector< markedSeq<SPAN> >> msInPart;
             seq_idx_t seq_index = 0;
 
-            for (it.first(); !it.isDone(); it.next()) // BankFasta
+            string seq, comment;
+            while (it.read(seq, comment))
             {
-                const string seq = it->toString();
-                const string comment = it->getComment();
-
                 const string kmerBegin = seq.substr(0, k );
                 const string kmerEnd = seq.substr(seq.size() - k , k );
 
@@ -1169,10 +1310,9 @@ void bglue(Storage *storage,
             sequences.reserve(copy_nb_seqs_in_partition[partition]);
             abundances.reserve(copy_nb_seqs_in_partition[partition]);
             
-            for (it.first(); !it.isDone(); it.next()) // BankFasta
+            it.restart();
+            while (it.read(seq, comment))
             {
-                const string seq = it->toString();
-                const string comment = it->getComment();
                 const string abundance_str = comment.substr(3);
                 sequences.push_back(seq);
                 abundances.push_back(abundance_str);
@@ -1194,8 +1334,6 @@ void bglue(Storage *storage,
             free_memory_vector(seqs_to_glue);
             free_memory_vector(seqs_to_glue_is_circular);
 
-            partitionBank.finalize(); // BankFasta
-
             System::file().remove (partitionFile);
 
         };
@@ -1205,8 +1343,21 @@ void bglue(Storage *storage,
     }
 
     pool.join();
-   
-   out.flush(); // not sure if necessary
+
+    // append the shards to the main output
+    for (int i = 0; i < nb_threads; i++)
+    {
+        delete outShards[i]; // final flush
+        string shardFile = outShard_prefix + std::to_string(i);
+        UnbufferedFastaIterator shard(shardFile);
+        string seq, comment;
+        while (shard.read(seq, comment))
+            output(seq, out, comment);
+        System::file().remove (shardFile);
+    }
+    free_memory_vector(outShards);
+
+    out.flush(); // not sure if necessary
 
     logging("end");
 
@@ -99,6 +99,82 @@ class BufferedFasta
         }
 };
 
+// binary counterpart of BufferedFasta, used for glue partitions: records are [uint32 seq size][uint32 comment size][seq][comment]
+// so that reading a partition back doesn't need any FASTA parsing
+class BufferedGluePartition
+{
+        std::mutex mtx;
+        std::string buffer;
+        FILE* _insertHandle;
+
+    public:
+        unsigned long max_buffer;
+
+        BufferedGluePartition(const std::string filename, unsigned long given_max_buffer = 50000)
+        {
+            max_buffer = given_max_buffer;
+            _insertHandle = fopen (filename.c_str(), "wb");
+            if (!_insertHandle) { std::cout << "error opening " << filename << " for writing." << std::endl; exit(1);}
+            buffer.reserve(max_buffer+1000/*security*/);
+        }
+
+        ~BufferedGluePartition()
+        {
+            flush();
+            fclose(_insertHandle);
+            std::string().swap(buffer);
+        }
+
+        void insert(const std::string &seq, const std::string &comment)
+        {
+            uint32_t sizes[2] = {(uint32_t)seq.size(), (uint32_t)comment.size()};
+            mtx.lock();
+            if (buffer.size() + sizeof(sizes) + seq.size() + comment.size() > max_buffer)
+                flush();
+            buffer.append((const char*)sizes, sizeof(sizes));
+            buffer += seq;
+            buffer += comment;
+            mtx.unlock();
+        }
+
+        void flush()
+        {
+            if (buffer.size() > 0 && fwrite (buffer.data(), 1, buffer.size(), _insertHandle) != buffer.size())
+            {  std::cout << "couldn't flush glue partition (" << buffer.size() << " bytes)" << std::endl; exit(1);}
+            buffer.clear();
+        }
+};
+
+class GluePartitionIterator
+{
+        std::ifstream *input;
+    public:
+        GluePartitionIterator(const std::string &filename)
+        {
+            input = new std::ifstream(filename, std::ios::binary);
+        }
+
+        ~GluePartitionIterator() { delete input;}
+
+        bool read(std::string &seq, std::string &comment)
+        {
+            uint32_t sizes[2];
+            if (!input->read((char*)sizes, sizeof(sizes)))
+                return false;
+            seq.resize(sizes[0]);
+            comment.resize(sizes[1]);
+            input->read(&seq[0], sizes[0]);
+            input->read(&comment[0], sizes[1]);
+            return (bool)(*input);
+        }
+
+        void restart()
+        {
+            input->clear();
+            input->seekg(0);
+        }
+};
+
 // not using BankFasta because I suspect that it does some funky memory fragmentation. so this one is unbuffered
 class UnbufferedFastaIterator 
 {
@@ -151,7 +227,8 @@ void bglue(gatb::core::tools::storage::impl::Storage* storage,
         int nb_glue_partitions, 
         int nb_threads, 
         bool all_abundance_counts,
-        bool verbose
+        bool verbose,
+        int max_memory = 0
         );
 
 }}}}
@@ -180,6 +180,69 @@ public:
     mutable std::vector<std::atomic<uint64_t>> mData;
 };
 
+/**
+ * Compact variant of the lock-free union-find above, used by bglue when memory is bounded.
+ *
+ * Only the 32-bit parent of each element is stored (no rank): a root is always linked
+ * under the root of smaller id, so parents strictly decrease along a path and find()
+ * terminates; path halving keeps paths short. Once all unions are done, flatten()
+ * makes every element point to its class representant, so that mData can directly
+ * be used as the (element -> class) vector without mirroring it somewhere else.
+ *
+ * Memory is 4 bytes per element instead of 8 for the ranked version.
+ */
+class unionFindCompact {
+public:
+    unionFindCompact(uint32_t size) : mData(size) {
+        for (uint32_t i=0; i<size; ++i)
+            mData[i] = i;
+    }
+
+    uint32_t find(uint32_t id) {
+        for (;;) {
+            uint32_t p = parent(id);
+            if (p == id)
+                return id;
+            uint32_t gp = parent(p);
+            /* Try to halve the path (may fail, that's ok) */
+            if (p != gp)
+                __sync_bool_compare_and_swap(&mData[id], p, gp);
+            id = gp;
+        }
+    }
+
+    uint32_t union_(uint32_t id1, uint32_t id2) {
+        for (;;) {
+            id1 = find(id1);
+            id2 = find(id2);
+
+            if (id1 == id2)
+                return id1;
+
+            if (id1 < id2)
+                std::swap(id1, id2);
+
+            /* link the larger root under the smaller one, retry if id1 stopped being a root meanwhile */
+            if (__sync_bool_compare_and_swap(&mData[id1], id1, id2))
+                return id2;
+        }
+    }
+
+    /* not thread-safe, to be called once all union_() calls are finished */
+    void flatten() {
+        for (uint32_t i=0; i<size(); ++i)
+            mData[i] = mData[mData[i]]; // parents have smaller ids, so they are already flattened
+    }
+
+    uint32_t size() const { return (uint32_t) mData.size(); }
+
+    uint32_t parent(uint32_t id) const {
+        return __atomic_load_n(&mData[id], __ATOMIC_RELAXED);
+    }
+
+    std::vector<uint32_t> mData;
+};
+
 #endif /* __UNIONFIND_H */
 
 // this one below works fine but uses an unordered_map; so two problem:
@@ -52,7 +52,7 @@ FrontlineTemplate<Node,Edge,Graph>::FrontlineTemplate (
 {
     _already_frontlined.insert (startingNode.kmer);
 
-    _frontline.push (NodeNt<Node>(startingNode, kmer::NUCL_UNKNOWN));
+    _frontline.push_back (NodeNt<Node>(startingNode, kmer::NUCL_UNKNOWN));
 }
 
 /*********************************************************************
@@ -71,7 +71,7 @@ FrontlineTemplate<Node,Edge,Graph>::FrontlineTemplate (
     TerminatorTemplate<Node,Edge,Graph>&       terminator,
     Node&       startingNode,
     Node&       previousNode,
-    std::set<Node>*   all_involved_extensions
+    NodesFlatSet<Node>* all_involved_extensions
 ) :
     _direction(direction), _graph(graph), _terminator(terminator), _depth(0),
     _all_involved_extensions(all_involved_extensions)
@@ -79,7 +79,7 @@ FrontlineTemplate<Node,Edge,Graph>::FrontlineTemplate (
     _already_frontlined.insert (startingNode.kmer);
     _already_frontlined.insert (previousNode.kmer);
 
-    _frontline.push (NodeNt<Node>(startingNode, kmer::NUCL_UNKNOWN));
+    _frontline.push_back (NodeNt<Node>(startingNode, kmer::NUCL_UNKNOWN));
 }
 
 /*********************************************************************
@@ -95,16 +95,15 @@ bool FrontlineTemplate<Node,Edge,Graph>::go_next_depth()
 {
     // extend all nodes in this frontline simultaneously, creating a new frontline
     stopped_reason=NONE;
-    queue_nodes new_frontline;
+    _new_frontline.clear();
 
-    while (!this->_frontline.empty())
+    for (size_t n=0; n<_frontline.size(); n++)
     {
-        /** We get the first item of the queue and remove it from the queue. */
-        NodeNt<Node> current_node = this->_frontline.front();
-        _frontline.pop();
+        /** We get the nodes of the current depth in the order they were added. */
+        NodeNt<Node>& current_node = _frontline[n];
 
         /** We check whether we use this node or not. we always use the first node at depth 0 */
-        if (_depth > 0 && check(current_node.node) == false)  { return false; }
+        if (_depth > 0 && check(current_node.node) == false)  { _frontline.erase (_frontline.begin(), _frontline.begin()+n+1);  return false; }
 
         /** We loop the neighbors edges of the current node. */
         GraphVector<Edge> edges = _graph.neighborsEdge (current_node.node, _direction);
@@ -116,13 +115,15 @@ bool FrontlineTemplate<Node,Edge,Graph>::go_next_depth()
             Node& neighbor = edge.to;
 
             // test if that node hasn't already been explored
-            if (_already_frontlined.find (neighbor.kmer) != _already_frontlined.end())  { continue; }
+            if (_already_frontlined.contains (neighbor.kmer))  { continue; }
 
             // if this bubble contains a marked (branching) kmer, stop everyone at once (to avoid redundancy)
             //if (_terminator.isEnabled() && _terminator.is_branching (neighbor) &&  _terminator.is_marked_branching(neighbor))   // legacy, before MPHFTerminator
             if (_terminator.isEnabled() && _terminator.is_marked(neighbor))   // to accomodate MPHFTerminator
             {  
                 stopped_reason=FrontlineTemplate<Node,Edge,Graph>::MARKED;
+                // like a queue would, only keep the nodes that were not extended yet
+                _frontline.erase (_frontline.begin(), _frontline.begin()+n+1);
                 return false;  
             }
 
@@ -130,7 +131,7 @@ bool FrontlineTemplate<Node,Edge,Graph>::go_next_depth()
             kmer::Nucleotide from_nt = (current_node.nt == kmer::NUCL_UNKNOWN) ? edge.nt : current_node.nt;
 
             /** We add the new node to the new front line. */
-            new_frontline.push (NodeNt<Node> (neighbor, from_nt));
+            _new_frontline.push_back (NodeNt<Node> (neighbor, from_nt));
 
             /** We memorize the new node. */
             _already_frontlined.insert (neighbor.kmer);
@@ -140,7 +141,7 @@ bool FrontlineTemplate<Node,Edge,Graph>::go_next_depth()
         }
     }
 
-    _frontline = new_frontline;
+    _frontline.swap (_new_frontline);
     ++_depth;
 
     return true;
@@ -161,7 +162,7 @@ FrontlineBranchingTemplate<Node,Edge,Graph>::FrontlineBranchingTemplate (
     TerminatorTemplate<Node,Edge,Graph>&       terminator,
     Node&       startingNode,
     Node&       previousNode,
-    std::set<Node>*   all_involved_extensions
+    NodesFlatSet<Node>* all_involved_extensions
 )  : FrontlineTemplate<Node,Edge,Graph>(direction,graph,terminator,startingNode,previousNode,all_involved_extensions)
 {
 }
@@ -210,7 +211,7 @@ bool FrontlineBranchingTemplate<Node,Edge,Graph>::check (Node& node)
         // only check in-branching from kmers not already frontlined
         // which, for the first extension, includes the previously traversed kmer (previous_kmer)
         // btw due to avance() invariant, previous_kmer is always within a simple path
-        if (this->_already_frontlined.find (neighbor.kmer) != this->_already_frontlined.end())  {   continue;  }
+        if (this->_already_frontlined.contains (neighbor.kmer))  {   continue;  }
 
         // create a new frontline inside this frontline to check for large in-branching (i know, we need to go deeper, etc..)
         FrontlineTemplate<Node,Edge,Graph> frontline (this->_direction, this->_graph, this->_terminator, neighbor, actual, this->_all_involved_extensions);
@@ -266,7 +267,7 @@ FrontlineReachableTemplate<Node,Edge,Graph>::FrontlineReachableTemplate(
     TerminatorTemplate<Node,Edge,Graph>&       terminator,
     Node&       startingNode,
     Node&       previousNode,
-    std::set<Node>*   all_involved_extensions
+    NodesFlatSet<Node>* all_involved_extensions
 )  : FrontlineTemplate<Node,Edge,Graph> (direction,graph,terminator,startingNode,previousNode,all_involved_extensions)
 {
 }
@@ -286,7 +287,7 @@ bool FrontlineReachableTemplate<Node,Edge,Graph>::check (Node& node)
     {
         /** Shortcut. */
         Node& neighbor = neighbors[i];
-        if (this->_already_frontlined.find (neighbor.kmer) == this->_already_frontlined.end())  {
+        if (!this->_already_frontlined.contains (neighbor.kmer))  {
             checkLater.insert(neighbor);
            //return false;   // strict
         }
@@ -297,9 +298,9 @@ bool FrontlineReachableTemplate<Node,Edge,Graph>::check (Node& node)
 template <typename Node, typename Edge, typename Graph>
 bool FrontlineReachableTemplate<Node,Edge,Graph>::isReachable()
 {
-   for (typename std::set<Node>::iterator itNode = checkLater.begin(); itNode != checkLater.end(); itNode++)
+   for (size_t i=0; i<checkLater.size(); i++)
    {
-        if (this->_already_frontlined.find((*itNode).kmer) == this->_already_frontlined.end())
+        if (!this->_already_frontlined.contains (checkLater[i].kmer))
             return false;
 
    }
@@ -23,8 +23,8 @@
 /********************************************************************************/
 
 #include <gatb/debruijn/impl/Terminator.hpp>
-#include <set>
-#include <queue>
+#include <gatb/debruijn/impl/NodesFlatSet.hpp>
+#include <vector>
 
 /********************************************************************************/
 namespace gatb      {
@@ -66,7 +66,7 @@ public:
         TerminatorTemplate<Node,Edge,Graph>&       terminator,
         Node&       startingNode,
         Node&       previousNode,
-        std::set<Node>*   all_involved_extensions = 0
+        NodesFlatSet<Node>* all_involved_extensions = 0
     );
 
     /** Constructor. */
@@ -86,7 +86,7 @@ public:
     size_t size  () const  {  return _frontline.size();  }
     size_t depth () const  {  return _depth;             }
 
-    NodeNt<Node> front () { return _frontline.front(); }
+    NodeNt<Node> front () { return _frontline[0]; }
 
     enum reason
     {
@@ -109,14 +109,16 @@ protected:
 
     TerminatorTemplate<Node,Edge,Graph>&  _terminator;
 
-    typedef std::queue<NodeNt<Node> > queue_nodes;
+    // current depth of the BFS, and the next one being built by go_next_depth (swapped afterwards, so that buffers are reused)
+    typedef std::vector<NodeNt<Node> > queue_nodes;
     queue_nodes _frontline;
+    queue_nodes _new_frontline;
 
     int  _depth;
 
-    std::set<Node>* _all_involved_extensions;
+    NodesFlatSet<Node>* _all_involved_extensions;
 
-    std::set<typename Node::Value> _already_frontlined; // making it simpler now
+    NodesFlatSet<typename Node::Value> _already_frontlined; // making it simpler now
 };
 
 /********************************************************************************/
@@ -134,7 +136,7 @@ public:
         TerminatorTemplate<Node,Edge,Graph>&       terminator,
         Node&       startingNode,
         Node&       previousNode,
-        std::set<Node>*   all_involved_extensions
+        NodesFlatSet<Node>* all_involved_extensions
     );
 
     /** Constructor. */
@@ -164,7 +166,7 @@ public:
         TerminatorTemplate<Node,Edge,Graph>&       terminator,
         Node&       startingNode,
         Node&       previousNode,
-        std::set<Node>*   all_involved_extensions
+        NodesFlatSet<Node>* all_involved_extensions
     );
 
     bool isReachable();
@@ -172,7 +174,7 @@ public:
 private:
 
     bool check (Node& node);
-    std::set<Node> checkLater;
+    NodesFlatSet<Node> checkLater;
 };
 
 typedef FrontlineTemplate<Node, Edge, Graph> Frontline; 
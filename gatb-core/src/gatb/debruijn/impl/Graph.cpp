@@ -3299,7 +3299,7 @@ struct queryNodeState_visitor : public boost::static_visitor<int>    {
         unsigned long hashIndex = getNodeIndex<span>(data, node);
     	if(hashIndex == ULLONG_MAX) return 0; // node was not found in the mphf 
 
-        unsigned char value = (*(data._nodestate)).at(hashIndex / 2);
+        unsigned char value = __atomic_load_n (&(*(data._nodestate)).at(hashIndex / 2), __ATOMIC_RELAXED);
 
         if (hashIndex % 2 == 1)
             value >>= 4;
@@ -3337,16 +3337,18 @@ struct setNodeState_visitor : public boost::static_visitor<int>    {
 
         int maskedState = state & 0xF;
 
-        if (hashIndex % 2 == 1)
+        // two nodes share the same byte, so the nibble is updated with a CAS loop
+        // in order to allow concurrent state updates without a synchronizer
+        unsigned char oldValue, newValue;
+        do
         {
-            value &= 0xF;
-            value |= (maskedState << 4);
-        }
-        else
-        {
-            value &= 0xF0;
-            value |= maskedState;
+            oldValue = __atomic_load_n (&value, __ATOMIC_RELAXED);
+            if (hashIndex % 2 == 1)
+                newValue = (oldValue & 0xF)  | (maskedState << 4);
+            else
+                newValue = (oldValue & 0xF0) | maskedState;
         }
+        while (!__sync_bool_compare_and_swap (&value, oldValue, newValue));
 
         return 0;
     }
@@ -3628,12 +3630,14 @@ void GraphTemplate<Node, Edge, GraphDataVariant>::deleteNode (Node& node) const
                         }
                         //std::cout << "deleting node with value " << (int)value << " and dir :" << (dir == DIR_INCOMING ? "incoming": "outcoming") << ": neighbor" << ((neighbor.strand==STRAND_REVCOMP) ? "(r)":"")<<" " << this->toString(neighbor) << " --(nt=" << nt << ")--> neigh_of_neigh"  << ((neigh_of_neigh.strand==STRAND_REVCOMP) ? "(r)":"")<< " " << this->toString(neigh_of_neigh) << std::endl;
 
-                        if (((value >> shift) & bit) == 0) // TODO remove this check if no problem after a while
+                        // atomic, as neighbors of a node can be deleted concurrently (they each clear a different bit)
+                        unsigned char oldValue = __sync_fetch_and_xor (&value, (unsigned char)(bit << shift));
+
+                        if (((oldValue >> shift) & bit) == 0) // TODO remove this check if no problem after a while
                         {
-                            std::cout << "Error while deleting node " <<  this->toString(node) << ": neighbor" << ((neighbor.strand==STRAND_REVCOMP) ? "(r)":"")<<" " << this->toString(neighbor) << " --(nt=" << nt << ")--> neigh_of_neigh"  << ((neigh_of_neigh.strand==STRAND_REVCOMP) ? "(r)":"")<< " " << this->toString(neigh_of_neigh) << " and dir :" << (dir == DIR_INCOMING ? "incoming": "outcoming") << ", value " << (int)value << std::endl;
+                            std::cout << "Error while deleting node " <<  this->toString(node) << ": neighbor" << ((neighbor.strand==STRAND_REVCOMP) ? "(r)":"")<<" " << this->toString(neighbor) << " --(nt=" << nt << ")--> neigh_of_neigh"  << ((neigh_of_neigh.strand==STRAND_REVCOMP) ? "(r)":"")<< " " << this->toString(neigh_of_neigh) << " and dir :" << (dir == DIR_INCOMING ? "incoming": "outcoming") << ", value " << (int)oldValue << std::endl;
                             exit(1);
                         }
-                        value ^= (bit << shift);
                         
                         deleted = true;
                     }
@@ -3722,18 +3726,23 @@ bool GraphTemplate<Node, Edge, GraphDataVariant>::debugCompareNeighborhoods(Node
 
 // TODO: it makes sense someday to introduce a graph._nbCore parameter, because this function, simplify() and precomputeAdjacency() all want it
 template<typename Node, typename Edge, typename GraphDataVariant>
-void GraphTemplate<Node, Edge, GraphDataVariant>::deleteNodesByIndex(vector<bool> &bitmap, int nbCores, gatb::core::system::ISynchronizer* synchro) const
+void GraphTemplate<Node, Edge, GraphDataVariant>::deleteNodesByIndex(NodesBitmap &bitmap, int nbCores, gatb::core::system::ISynchronizer* synchro) const
 {
     GraphIterator<Node> itNode = this->iterator();
     Dispatcher dispatcher (nbCores); 
 
+    // node state and adjacency updates done by deleteNode() are atomic, so nodes can be deleted concurrently.
+    // only the non-simple nodes cache (a std::map) still needs the synchronizer
+    bool _cacheNonSimpleNodes = getState() & GraphTemplate<Node, Edge, GraphDataVariant>::STATE_NONSIMPLE_CACHE;
+    if (!_cacheNonSimpleNodes)
+        synchro = NULL;
+
     dispatcher.iterate (itNode, [&] (Node& node)        {
 
         unsigned long i = this->nodeMPHFIndex(node); 
 
         if (bitmap[i])
         {
-            // make this deletion atomic with respect to other node deletions
             if (synchro)
                 synchro->lock();
 
@@ -50,6 +50,7 @@
 
 #include <gatb/tools/storage/impl/Storage.hpp>
 
+#include <gatb/debruijn/impl/NodesBitmap.hpp>
 #include <gatb/debruijn/impl/NodesDeleter.hpp>
 
 /********************************************************************************/
@@ -909,7 +910,7 @@ public:
 
     // deleted nodes, related to NodeState above
     void deleteNode (Node& node) const;
-    void deleteNodesByIndex(std::vector<bool> &bitmap, int nbCores = 1, gatb::core::system::ISynchronizer* synchro=NULL) const;
+    void deleteNodesByIndex(NodesBitmap &bitmap, int nbCores = 1, gatb::core::system::ISynchronizer* synchro=NULL) const;
     bool isNodeDeleted(Node& node) const;
 
     // a direct query to the MPHF data strcuture
@@ -1263,7 +1264,7 @@ struct GraphData
         {
             unsigned long hashIndex = ((_nodestate))->getCode(item);
 			if(hashIndex == ULLONG_MAX) return false;
-            unsigned char value = ((_nodestate))->at(hashIndex / 2);
+            unsigned char value = __atomic_load_n (&((_nodestate))->at(hashIndex / 2), __ATOMIC_RELAXED);
             if ((hashIndex % 2) == 1)
                 value >>= 4;
             value &= 0xF;
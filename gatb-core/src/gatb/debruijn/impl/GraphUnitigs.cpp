@@ -45,6 +45,7 @@
 #include <gatb/kmer/impl/RepartitionAlgorithm.hpp>
 
 #include <gatb/debruijn/impl/Simplifications.hpp>
+#include <gatb/debruijn/impl/UnitigSimplifications.hpp>
 
 // for trim()
 #include <functional> 
@@ -826,6 +827,11 @@ GraphUnitigsTemplate<span>::GraphUnitigsTemplate (tools::misc::IProperties* para
             BaseGraph::_storageMode = tools::storage::impl::STORAGE_FILE; // moving away frmo HDF5 because 1) memory leaks and 2) storing unitigs in a fasta file instead, more clean this way. nothing else needs to be stored
             std::cout << "setting storage type to file" << std::endl;
         }
+        else if (storage_type == "packed")
+        {
+            BaseGraph::_storageMode = tools::storage::impl::STORAGE_PACKED_FILE;
+            std::cout << "setting storage type to packed file" << std::endl;
+        }
         else
         {std::cout << "Error: unknown storage type specified: " << storage_type << std::endl; exit(1); }
     }
@@ -1406,7 +1412,7 @@ void GraphUnitigsTemplate<span>::cacheNonSimpleNodes(unsigned int nbCores, bool
 }
  
 template<size_t span>
-void GraphUnitigsTemplate<span>::deleteNodesByIndex(vector<bool> &bitmap, int nbCores, gatb::core::system::ISynchronizer* synchro) 
+void GraphUnitigsTemplate<span>::deleteNodesByIndex(NodesBitmap &bitmap, int nbCores, gatb::core::system::ISynchronizer* synchro) 
 {
     for (unsigned long i = 0; i < bitmap.size(); i++)
         if (bitmap[i])
@@ -1985,6 +1991,13 @@ void GraphUnitigsTemplate<span>::simplify(unsigned int nbCores, bool verbose)
         graphSimplifications.simplify();
 }
 
+template<size_t span>
+void GraphUnitigsTemplate<span>::simplifyUnitigs(unsigned int nbCores, bool verbose)
+{
+        UnitigSimplifications<span> graphSimplifications(this, nbCores, verbose);
+        graphSimplifications.simplify();
+}
+
 
 /*
  *
@@ -2086,6 +2099,72 @@ unsigned int GraphUnitigsTemplate<span>::internal_get_unitig_length(unsigned int
     return unitigs_sizes[id];
 }
 
+template<size_t span>
+void GraphUnitigsTemplate<span>::internal_get_links(uint64_t id, bool outcoming_side, const uint64_t*& begin, const uint64_t*& end) const
+{
+    const std::vector<uint64_t>& v = outcoming_side ? outcoming : incoming;
+    uint64_t b, e;
+    if (compress_navigational_vectors)
+    {
+        const dag::dag_vector& v_map = outcoming_side ? dag_outcoming_map : dag_incoming_map;
+        b = (id == 0) ? 0 : v_map.prefix_sum(id);
+        e = (id == v_map.size() - 1) ? v.size() : b + v_map[id];
+    }
+    else
+    {
+        const std::vector<uint64_t>& v_map = outcoming_side ? outcoming_map : incoming_map;
+        b = v_map[id];
+        e = (id == v_map.size() - 1) ? v.size() : v_map[id+1];
+    }
+    begin = v.data() + b;
+    end   = v.data() + e;
+}
+
+/* rebuilds incoming/outcoming without the links to (and from) deleted unitigs.
+ * unitig ids don't change, so nodes remain valid */
+template<size_t span>
+void GraphUnitigsTemplate<span>::internal_compact_links()
+{
+    std::vector<uint64_t> new_incoming, new_outcoming, new_incoming_map, new_outcoming_map;
+    dag::dag_vector new_dag_incoming_map, new_dag_outcoming_map;
+    std::vector<uint64_t> inc, outc;
+
+    for (uint64_t i = 0; i < nb_unitigs; i++)
+    {
+        inc.clear(); outc.clear();
+        if (!unitigs_deleted[i])
+        {
+            const uint64_t *it, *end;
+            internal_get_links(i, false, it, end);
+            for (; it != end; it++)
+                if (!unitigs_deleted[ExtremityInfo(*it).unitig])
+                    inc.push_back(*it);
+            internal_get_links(i, true, it, end);
+            for (; it != end; it++)
+                if (!unitigs_deleted[ExtremityInfo(*it).unitig])
+                    outc.push_back(*it);
+        }
+
+        if (compress_navigational_vectors)
+        {
+            insert_compressed_navigational_vector(new_incoming,  inc,  new_dag_incoming_map);
+            insert_compressed_navigational_vector(new_outcoming, outc, new_dag_outcoming_map);
+        }
+        else
+        {
+            insert_navigational_vector(new_incoming,  inc,  new_incoming_map);
+            insert_navigational_vector(new_outcoming, outc, new_outcoming_map);
+        }
+    }
+
+    incoming.swap(new_incoming);
+    outcoming.swap(new_outcoming);
+    incoming_map.swap(new_incoming_map);
+    outcoming_map.swap(new_outcoming_map);
+    dag_incoming_map.swap(new_dag_incoming_map);
+    dag_outcoming_map.swap(new_dag_outcoming_map);
+}
+
 template<size_t span>
 std::string GraphUnitigsTemplate<span>::internal_compress_unitig(std::string seq) const
 {
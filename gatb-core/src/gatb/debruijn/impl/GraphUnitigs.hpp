@@ -254,6 +254,10 @@ public:
     /* perform tip removal, bulge removal and EC removal, as in Minia */
     void simplify(unsigned int nbCores = 1, bool verbose=false);
 
+    /* same simplifications, but decided on unitig records (length, abundance, links) instead of per-node traversals.
+     * much faster on large graphs, see UnitigSimplifications.hpp. also compacts the links of the graph afterwards */
+    void simplifyUnitigs(unsigned int nbCores = 1, bool verbose=false);
+
     /**********************************************************************/
     /*                         SIMPLE PATH METHODS                        */
     /**********************************************************************/
@@ -317,7 +321,7 @@ public:
     void setNodeState (const NodeGU& node, int state) const;
     void resetNodeState () const ;
     void disableNodeState () const ;
-    void deleteNodesByIndex(std::vector<bool> &bitmap, int nbCores = 1, gatb::core::system::ISynchronizer* synchro=NULL);
+    void deleteNodesByIndex(NodesBitmap &bitmap, int nbCores = 1, gatb::core::system::ISynchronizer* synchro=NULL);
     unsigned long nodeMPHFIndex(const NodeGU& node) const;
     void cacheNonSimpleNodes(unsigned int nbCores, bool verbose); 
 
@@ -406,6 +410,11 @@ public: // was private: before, but had many compilation errors during the chang
     // support for 2-bit compression of unitigs
     std::string internal_get_unitig_sequence(unsigned int unitig_id) const;
     unsigned int internal_get_unitig_length(unsigned int unitig_id) const;
+
+    // raw access to the links of a unitig (packed ExtremityInfo's, deleted neighbors included), to the left (incoming) or to the right (outcoming)
+    void internal_get_links(uint64_t unitig_id, bool outcoming_side, const uint64_t*& begin, const uint64_t*& end) const;
+    // removes links to deleted unitigs from the navigational vectors
+    void internal_compact_links();
     std::string internal_compress_unitig(std::string seq) const;
 
     typedef typename kmer::impl::Kmer<span>::ModelCanonical Model;
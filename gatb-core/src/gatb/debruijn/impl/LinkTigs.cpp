@@ -8,8 +8,8 @@
 #include <gatb/debruijn/impl/ExtremityInfo.hpp>
 #include <gatb/debruijn/impl/LinkTigs.hpp>
 #include <gatb/kmer/impl/Model.hpp> // for revcomp_4NT
+#include <gatb/tools/collections/impl/KWayMerge.hpp>
 
-#include <queue>
 #include <string>
 #include <unordered_map>
 
@@ -22,6 +22,7 @@ using namespace gatb::core::debruijn::impl;
 using namespace gatb::core::kmer;
 using namespace gatb::core::kmer::impl;
 
+using namespace gatb::core::tools::collections::impl;
 using namespace gatb::core::tools::misc;
 using namespace gatb::core::tools::misc::impl;
 using namespace gatb::core::system;
@@ -116,9 +117,16 @@ static void write_final_output(const string& unitigs_filename, bool verbose, Ban
     logging("gathering links from disk");
     std::ifstream* inputLinks[nb_passes];
 
-    bitset<nb_passes> finished;
-    typedef std::tuple<uint64_t /*unitig id*/, int /*pass*/, std::string /*links */> pq_elt_t;
-    priority_queue<pq_elt_t, vector<pq_elt_t>, std::greater<pq_elt_t> > pq;
+    // current link of each pass; ties on the unitig are broken by pass, so links are gathered in pass order
+    vector<uint64_t> unitigs (nb_passes);
+    vector<string>   links   (nb_passes);
+    struct LinkLess
+    {
+        LinkLess (const vector<uint64_t>& unitigs) : _unitigs(unitigs) {}
+        bool operator() (size_t a, size_t b) const  { return _unitigs[a] < _unitigs[b] || (_unitigs[a] == _unitigs[b] && a < b); }
+        const vector<uint64_t>& _unitigs;
+    };
+    LoserTree<LinkLess> tree (nb_passes, LinkLess (unitigs));
     
     BankFasta inputBank (unitigs_filename);
     BankFasta::Iterator itSeq (inputBank);
@@ -130,14 +138,12 @@ static void write_final_output(const string& unitigs_filename, bool verbose, Ban
 
     for (int pass = 0; pass < nb_passes; pass++)
     {
-        string link; uint64_t unitig;
         inputLinks[pass] = new std::ifstream(unitigs_filename+ ".links." + to_string(pass));
-        // prime the pq with the first element in the file
-        if (get_link_from_file(*inputLinks[pass], link, unitig))
-            pq.emplace(make_tuple(unitig, pass, link));
-        else
-            finished[pass] = true;
+        // prime the tree with the first element in the file
+        if (!get_link_from_file(*inputLinks[pass], links[pass], unitigs[pass]))
+            tree.setDone(pass);
     }
+    tree.build();
 
     uint64_t last_unitig = 0;
     nb_unitigs = 0; // passed variable
@@ -147,11 +153,10 @@ static void write_final_output(const string& unitigs_filename, bool verbose, Ban
  
 
     // nb_passes-way merge sort
-    while ((!finished.all()) || pq.size() > 0)
+    while (!tree.isDone())
     {
-        pq_elt_t cur = pq.top(); pq.pop();
-        int pass = get<1>(cur);
-        uint64_t unitig = get<0>(cur);
+        int pass = tree.top();
+        uint64_t unitig = unitigs[pass];
 
         if (first_one) // handles the case where first unitig isn't labeled 0
         {
@@ -177,18 +182,13 @@ static void write_final_output(const string& unitigs_filename, bool verbose, Ban
                 comment = to_string(nb_unitigs) + " " + strip_first_field(comment);
         }
             
-        cur_links += get<2>(cur);
+        cur_links += links[pass];
         //if (unitig < 10)  std::cout << " popped " << pass << " " << unitig << " " << cur_links << std::endl; // debug
 
         // read next entry in the inputLinks[pass] file that we just popped
-        if (finished[pass])
-            continue;
-        string link;
-        if (get_link_from_file(*inputLinks[pass], link, unitig))
-            pq.emplace(make_tuple(unitig, pass, link));
-        else
-            finished[pass] = true;
-
+        if (!get_link_from_file(*inputLinks[pass], links[pass], unitigs[pass]))
+            tree.setDone(pass);
+        tree.replay();
     }
     // write the last element
     Sequence s (Data::ASCII);
@@ -0,0 +1,73 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2015 INRIA
+ *   Authors: R.Chikhi, G.Rizk, D.Lavenier, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+// a bit array indexed by node MPHF index (or unitig index), used to mark nodes to delete.
+// unlike std::vector<bool>, bits can be set concurrently by several threads:
+// each set() is an atomic OR on the 64-bit word holding the bit.
+
+#ifndef _GATB_GRAPH_NODESBITMAP_HPP_
+#define _GATB_GRAPH_NODESBITMAP_HPP_
+
+/********************************************************************************/
+
+#include <vector>
+#include <sys/types.h>
+
+/********************************************************************************/
+namespace gatb {  namespace core {  namespace debruijn {  namespace impl {
+/********************************************************************************/
+
+class NodesBitmap
+{
+public:
+
+    NodesBitmap (u_int64_t size = 0)  { resize (size); }
+
+    void resize (u_int64_t size)
+    {
+        _size = size;
+        _words.assign ((size + 63) / 64, 0); // (!) this will alloc 1 bit per node.
+    }
+
+    u_int64_t size () const  { return _size; }
+
+    bool operator[] (u_int64_t i) const
+    {
+        return (__atomic_load_n (&_words[i >> 6], __ATOMIC_RELAXED) >> (i & 63)) & 1;
+    }
+
+    /** Set bit i; can be called concurrently with other set() calls.
+     * \return true if the bit was not set before. */
+    bool set (u_int64_t i)
+    {
+        u_int64_t mask = (u_int64_t)1 << (i & 63);
+        return (__sync_fetch_and_or (&_words[i >> 6], mask) & mask) == 0;
+    }
+
+private:
+
+    std::vector<u_int64_t> _words;
+    u_int64_t              _size;
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif
@@ -26,6 +26,7 @@
 /********************************************************************************/
 
 #include <gatb/debruijn/impl/Graph.hpp>
+#include <gatb/debruijn/impl/NodesBitmap.hpp>
 #include <gatb/system/impl/System.hpp>
 #include <vector>
 #include <set>
@@ -42,7 +43,7 @@ class NodesDeleter
 
     public:
         uint64_t nbNodes;
-        std::vector<bool> nodesToDelete; // don't delete while parallel traversal, do it afterwards
+        NodesBitmap nodesToDelete; // don't delete while parallel traversal, do it afterwards
         std::set<Node> setNodesToDelete; 
         Graph &  _graph;
         int _nbCores;
@@ -54,8 +55,6 @@ class NodesDeleter
     NodesDeleter(Graph&  graph, uint64_t nbNodes, int nbCores, bool verbose=true) : nbNodes(nbNodes), _graph(graph), _nbCores(nbCores), _verbose(verbose)
     {
         nodesToDelete.resize(nbNodes); // number of graph nodes // (!) this will alloc 1 bit per kmer.
-        for (unsigned long i = 0; i < nbNodes; i++)
-            nodesToDelete[i] = false;
 
         /* use explicit set of nodes as long as we don't have more than 10 M nodes ok? 
          * else resort to bit array
@@ -101,7 +100,7 @@ class NodesDeleter
     
     void markToDeleteIndex(uint64_t index)
     {
-            nodesToDelete[index] = true;
+            nodesToDelete.set(index);
     }
 
     void markToDelete(Node &node)
@@ -109,7 +108,7 @@ class NodesDeleter
         if (!onlyListMethod)
         {
             unsigned long index =_graph.nodeMPHFIndex(node);
-            nodesToDelete[index] = true;
+            nodesToDelete.set(index);
         }
 
         if (useList)
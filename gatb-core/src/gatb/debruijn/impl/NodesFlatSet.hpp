@@ -0,0 +1,190 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2015 INRIA
+ *   Authors: R.Chikhi, G.Rizk, D.Lavenier, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+// small open-addressing set of kmers (or nodes, compared on their kmer like Node_t::operator== does),
+// used for the visited sets of Frontline and MonumentTraversal instead of std::set.
+//
+// a traversal explores a few dozen kmers at most, so what matters is not to allocate: the storage of a set
+// comes from a per-thread pool and goes back to it when the set is destroyed, so that the next frontline
+// reuses it. emptying a set is O(1) (slots are stamped with a generation number).
+// items can be iterated in insertion order with size() and operator[].
+
+#ifndef _GATB_GRAPH_NODESFLATSET_HPP_
+#define _GATB_GRAPH_NODESFLATSET_HPP_
+
+/********************************************************************************/
+
+#include <vector>
+#include <sys/types.h>
+
+/********************************************************************************/
+namespace gatb {  namespace core {  namespace debruijn {  namespace impl {
+/********************************************************************************/
+
+template <typename Value_t> struct Node_t;
+
+/** What an item is compared and hashed on. */
+template <typename Item> struct FlatSetKey
+{
+    typedef Item Type;
+    static const Item& get (const Item& item)  { return item; }
+};
+
+template <typename Value_t> struct FlatSetKey<Node_t<Value_t> >
+{
+    typedef Value_t Type;
+    static const Value_t& get (const Node_t<Value_t>& node)  { return node.kmer; }
+};
+
+/********************************************************************************/
+
+template <typename Item>
+class NodesFlatSet
+{
+    typedef FlatSetKey<Item> Key;
+
+    struct Storage
+    {
+        std::vector<Item>      items;   // in insertion order
+        std::vector<u_int32_t> slots;   // index in items
+        std::vector<u_int32_t> stamps;  // a slot is used iff its stamp is the current generation
+        u_int32_t              generation;
+
+        Storage () : generation(0)  {}
+    };
+
+    struct Pool
+    {
+        std::vector<Storage*> free;
+        ~Pool ()  { for (size_t i=0; i<free.size(); i++)  { delete free[i]; } }
+    };
+
+    static Pool& pool ()  { static thread_local Pool p; return p; }
+
+    // don't keep in the pool the storage of a set that grew unusually large
+    static const size_t maxPooledCapacity = 1 << 16;
+    static const size_t initialCapacity   = 64;
+
+public:
+
+    NodesFlatSet () : _s(acquire())  {}
+
+    NodesFlatSet (const NodesFlatSet& other) : _s(acquire())
+    {
+        for (size_t i=0; i<other.size(); i++)  { insert (other[i]); }
+    }
+
+    NodesFlatSet& operator= (const NodesFlatSet& other)
+    {
+        if (this != &other)  { clear();  for (size_t i=0; i<other.size(); i++)  { insert (other[i]); } }
+        return *this;
+    }
+
+    ~NodesFlatSet ()  { release (_s); }
+
+    /** \return true if the item was not in the set before. */
+    bool insert (const Item& item)
+    {
+        if (2 * (_s->items.size() + 1) > _s->slots.size())  { grow(); }
+
+        size_t i = find (Key::get(item));
+        if (_s->stamps[i] == _s->generation)  { return false; }
+
+        _s->stamps[i] = _s->generation;
+        _s->slots [i] = _s->items.size();
+        _s->items.push_back (item);
+        return true;
+    }
+
+    bool contains (const typename Key::Type& key) const
+    {
+        return _s->stamps[find(key)] == _s->generation;
+    }
+
+    size_t size () const  { return _s->items.size(); }
+
+    const Item& operator[] (size_t i) const  { return _s->items[i]; }
+
+    void clear ()
+    {
+        _s->items.clear();
+        if (++_s->generation == 0)  { reset (_s, _s->slots.size()); }
+    }
+
+private:
+
+    Storage* _s;
+
+    static void reset (Storage* s, size_t capacity)
+    {
+        s->slots .assign (capacity, 0);
+        s->stamps.assign (capacity, 0);
+        s->generation = 1;
+    }
+
+    static Storage* acquire ()
+    {
+        Pool& p = pool();
+        if (p.free.empty())
+        {
+            Storage* s = new Storage();
+            reset (s, initialCapacity);
+            return s;
+        }
+        Storage* s = p.free.back();
+        p.free.pop_back();
+        s->items.clear();
+        if (++s->generation == 0)  { reset (s, s->slots.size()); }
+        return s;
+    }
+
+    static void release (Storage* s)
+    {
+        if (s->slots.size() > maxPooledCapacity)  { delete s;  return; }
+        pool().free.push_back (s);
+    }
+
+    /** slot holding the key, or empty slot where it would be inserted (linear probing) */
+    size_t find (const typename Key::Type& key) const
+    {
+        size_t mask = _s->slots.size() - 1;
+        size_t i    = oahash(key) & mask;
+        while (_s->stamps[i] == _s->generation && !(Key::get(_s->items[_s->slots[i]]) == key))  { i = (i + 1) & mask; }
+        return i;
+    }
+
+    void grow ()
+    {
+        reset (_s, _s->slots.size() * 2);
+        size_t mask = _s->slots.size() - 1;
+        for (size_t j=0; j<_s->items.size(); j++)
+        {
+            size_t i = oahash(Key::get(_s->items[j])) & mask;
+            while (_s->stamps[i] == _s->generation)  { i = (i + 1) & mask; }
+            _s->stamps[i] = _s->generation;
+            _s->slots [i] = j;
+        }
+    }
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif
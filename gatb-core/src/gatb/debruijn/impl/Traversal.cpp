@@ -399,11 +399,37 @@ bool MonumentTraversalTemplate<Node,Edge,Graph>::explore_branching (
     Node& previousNode
 )
 {
-    set<Node> all_involved_extensions;
+    NodesFlatSet<Node> all_involved_extensions;
 
     return explore_branching (node, dir, consensus, previousNode, all_involved_extensions);
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : std::set flavour of explore_branching, kept for the callers that need the involved extensions
+*********************************************************************/
+template <typename Node, typename Edge, typename Graph>
+bool MonumentTraversalTemplate<Node,Edge,Graph>::explore_branching (
+    Node& node,
+    Direction dir,
+    Path_t<Node>& consensus,
+    Node& previousNode,
+    std::set<Node>& all_involved_extensions
+)
+{
+    NodesFlatSet<Node> extensions;
+
+    bool success = explore_branching (node, dir, consensus, previousNode, extensions);
+
+    for (size_t i=0; i<extensions.size(); i++)  {  all_involved_extensions.insert (extensions[i]);  }
+
+    return success;
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -418,7 +444,7 @@ bool MonumentTraversalTemplate<Node,Edge,Graph>::explore_branching (
     Direction dir,
     Path_t<Node>& consensus,
     Node& previousNode,
-    std::set<Node>& all_involved_extensions
+    NodesFlatSet<Node>& all_involved_extensions
 )
 {
     Node endNode;
@@ -470,7 +496,7 @@ int MonumentTraversalTemplate<Node,Edge,Graph>::find_end_of_branching (
     Node&  startingNode,
     Node&        endNode,
     Node&  previousNode,
-    std::set<Node>& all_involved_extensions
+    NodesFlatSet<Node>& all_involved_extensions
 )
 {
     /** We need a branching frontline. */
@@ -539,13 +565,13 @@ int MonumentTraversalTemplate<Node,Edge,Graph>::find_end_of_branching (
 ** REMARKS :
 *********************************************************************/
 template <typename Node, typename Edge, typename Graph>
-void MonumentTraversalTemplate<Node,Edge,Graph>::mark_extensions (std::set<Node>& extensions_to_mark)
+void MonumentTraversalTemplate<Node,Edge,Graph>::mark_extensions (NodesFlatSet<Node>& extensions_to_mark)
 {
     if (this->terminator.isEnabled())
     {
-        for(typename std::set<Node>::iterator it = extensions_to_mark.begin(); it != extensions_to_mark.end() ; ++it)
+        for (size_t i=0; i<extensions_to_mark.size(); i++)
         {
-            Node node = *it; // need this, because terminator.mark will want to modify node to cache its mphf index, hence it cannot be const.
+            Node node = extensions_to_mark[i]; // need this, because terminator.mark will want to modify node to cache its mphf index, hence it cannot be const.
             this->terminator.mark (node);
         }
     }
@@ -565,7 +591,7 @@ set<Path_t<Node> > MonumentTraversalTemplate<Node,Edge,Graph>::all_consensuses_b
     Node& startNode,
     Node& endNode,
     int traversal_depth,
-    std::set<typename Node::Value> usedNode,
+    NodesFlatSet<typename Node::Value> usedNode,
     Path_t<Node> current_consensus,
     bool& success
 )
@@ -600,7 +626,7 @@ set<Path_t<Node> > MonumentTraversalTemplate<Node,Edge,Graph>::all_consensuses_b
         // don't resolve bubbles containing loops
         // (tandem repeats make things more complicated)
         // that's a job for a gapfiller
-        if (usedNode.find(edge.to.kmer) != usedNode.end())
+        if (usedNode.contains (edge.to.kmer))
         {
             success = false;
             this->stats.couldnt_consensus_loop++;
@@ -612,7 +638,7 @@ set<Path_t<Node> > MonumentTraversalTemplate<Node,Edge,Graph>::all_consensuses_b
         extended_consensus.push_back (edge.nt);
 
         // generate list of used kmers (to prevent loops)
-        set<typename Node::Value> extended_kmers (usedNode);
+        NodesFlatSet<typename Node::Value> extended_kmers (usedNode);
         extended_kmers.insert (edge.to.kmer);
 
         // recursive call to all_consensuses_between
@@ -658,7 +684,7 @@ set<Path_t<Node> > MonumentTraversalTemplate<Node,Edge,Graph>::all_consensuses_b
     bool &success
 )
 {
-    set<typename Node::Value> usedNode;
+    NodesFlatSet<typename Node::Value> usedNode;
     usedNode.insert(startNode.kmer);
     Path_t<Node> current_consensus;
     current_consensus.start = startNode;
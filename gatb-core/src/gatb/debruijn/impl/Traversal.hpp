@@ -21,6 +21,7 @@
 #define _GATB_TOOLS_TRAVERSAL_HPP_
 
 #include <gatb/debruijn/impl/Terminator.hpp>
+#include <gatb/debruijn/impl/NodesFlatSet.hpp>
 #include <gatb/tools/misc/api/Enums.hpp>
 #include <set>
 
@@ -341,12 +342,20 @@ private:
         Node& previousNode
     );
 
+    bool explore_branching (
+        Node& node,
+        Direction dir,
+        Path_t<Node>& consensus,
+        Node& previousNode,
+        NodesFlatSet<Node>& all_involved_extensions
+    );
+
     int find_end_of_branching (
         Direction dir,
         Node& startingNode,
         Node& endNode,
         Node& previousNode,
-        std::set<Node>& all_involved_extensions
+        NodesFlatSet<Node>& all_involved_extensions
     );
  
     std::set<Path_t<Node> > all_consensuses_between (
@@ -354,14 +363,14 @@ private:
         Node& startNode,
         Node& endNode,
         int traversal_depth,
-        std::set<typename Node::Value> usedNode,
+        NodesFlatSet<typename Node::Value> usedNode,
         Path_t<Node> current_consensus,
         bool& success
     );
    
     bool all_consensuses_almost_identical (std::set<Path_t<Node> >& consensuses);
 
-    void mark_extensions (std::set<Node>& extensions_to_mark);
+    void mark_extensions (NodesFlatSet<Node>& extensions_to_mark);
 
     Path_t<Node> most_abundant_consensus(std::set<Path_t<Node> >& consensuses);
 
@@ -0,0 +1,417 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014-2015  INRIA
+ *   Authors: R.Chikhi, G.Rizk, D.Lavenier, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef _GATB_CORE_DEBRUIJN_IMPL_UNITIG_SIMPLIFCPP_
+#define _GATB_CORE_DEBRUIJN_IMPL_UNITIG_SIMPLIFCPP_
+
+#include <gatb/debruijn/impl/UnitigSimplifications.hpp>
+#include <gatb/bcalm2/unionFind.hpp>
+#include <gatb/tools/designpattern/impl/Command.hpp>
+#include <gatb/tools/misc/api/Range.hpp>
+
+/********************************************************************************/
+namespace gatb {  namespace core {  namespace debruijn {  namespace impl {
+/********************************************************************************/
+
+static const uint64_t NO_EXTREMITY = ~0ULL;
+static const double   ABUNDANCE_FIXED_POINT = 1024; // chain abundances are summed atomically as integers
+
+/* parallel loop over all unitig ids */
+template<typename Functor>
+static void iterateUnitigs (uint64_t nbUnitigs, int nbCores, const Functor& functor)
+{
+    if (nbUnitigs == 0)
+        return;
+    tools::dp::impl::Dispatcher dispatcher (nbCores);
+    dispatcher.iterate (new tools::misc::Range<u_int64_t>::Iterator (0, nbUnitigs-1), [&] (u_int64_t u) { functor(u); }, 10000);
+}
+
+template<size_t span>
+UnitigSimplifications<span>::UnitigSimplifications (GraphUnitigsTemplate<span> *graph, int nbCores, bool verbose)
+    : _nbTipRemovalPasses(0), _nbBulgeRemovalPasses(0), _nbECRemovalPasses(0), _graph(*graph), _nbCores(nbCores), _verbose(verbose)
+{
+    _doTipRemoval = _doBulgeRemoval = _doECRemoval = true;
+
+    nbUnitigs = _graph.nb_unitigs;
+    if (nbUnitigs >= (uint64_t)(uint32_t)~0)
+    {
+        std::cout << "UnitigSimplifications: too many unitigs (" << nbUnitigs << ") for 32-bits unitig ids" << std::endl; exit(1);
+    }
+    cutoffEvents = std::max((uint64_t)(nbUnitigs / 10000), (uint64_t)1);
+
+    // same defaults as Simplifications
+    _tipLen_Topo_kMult = 2.5;
+    _tipLen_RCTC_kMult = 10;
+    _tipRCTCcutoff = 2;
+
+    _bulgeLen_kMult = 3;
+    _bulgeLen_kAdd = 100;
+    _bulgeAltPath_covMult = 1.1;
+
+    _ecLen_kMult = 9;
+    _ecRCTCcutoff = 4;
+}
+
+template<size_t span>
+void UnitigSimplifications<span>::simplify()
+{
+    tipRemoval = bulgeRemoval = ECRemoval = "";
+
+    auto record = [] (std::string& str, unsigned long nb) { if (str.size() != 0) str += " + "; str += std::to_string(nb); };
+    auto again  = [&] (unsigned long nb, int nbPasses) { return nb > 0 && (nb >= cutoffEvents || nbPasses <= 2) && nbPasses < 20; };
+
+    unsigned long nbTipsRemoved = 0, nbBulgesRemoved = 0, nbECRemoved = 0;
+
+    if (_doTipRemoval)
+        do { nbTipsRemoved = removeTips(); record(tipRemoval, nbTipsRemoved); }
+        while (again(nbTipsRemoved, _nbTipRemovalPasses));
+
+    if (_doBulgeRemoval)
+        do { nbBulgesRemoved = removeBulges(); record(bulgeRemoval, nbBulgesRemoved); }
+        while (again(nbBulgesRemoved, _nbBulgeRemovalPasses));
+
+    if (_doECRemoval)
+        do { nbECRemoved = removeErroneousConnections(); record(ECRemoval, nbECRemoved); }
+        while (again(nbECRemoved, _nbECRemovalPasses));
+
+    // final rounds: a mix of everything, as removing bulges/ECs creates new tips and conversely
+    if (_doTipRemoval && _doBulgeRemoval && _doECRemoval)
+    {
+        int nbRounds = 0;
+        do
+        {
+            nbTipsRemoved   = removeTips();                 record(tipRemoval,   nbTipsRemoved);
+            nbBulgesRemoved = removeBulges();               record(bulgeRemoval, nbBulgesRemoved);
+            nbECRemoved     = removeErroneousConnections(); record(ECRemoval,    nbECRemoved);
+        }
+        while ((nbTipsRemoved >= cutoffEvents || nbBulgesRemoved >= cutoffEvents || nbECRemoved >= cutoffEvents) && ++nbRounds < 20);
+    }
+
+    _graph.internal_compact_links();
+
+    std::vector<uint32_t>().swap(_chain);
+    std::vector<uint32_t>().swap(_chainKmers);
+    std::vector<uint64_t>().swap(_chainAbundance);
+    std::vector<uint64_t>().swap(_chainEnds);
+
+    if (_verbose)
+        std::cout << "unitig-level simplifications: tips removed: " << tipRemoval << ", bulges removed: " << bulgeRemoval << ", ECs removed: " << ECRemoval << std::endl;
+}
+
+template<size_t span>
+void UnitigSimplifications<span>::links (uint64_t extremity, const uint64_t*& begin, const uint64_t*& end) const
+{
+    _graph.internal_get_links(extremity >> 1, extremity & 1, begin, end);
+}
+
+/* number of non-deleted neighbors of an extremity; if there is exactly one, its (facing) extremity is returned in uniqueNeighbor */
+template<size_t span>
+unsigned int UnitigSimplifications<span>::liveDegree (uint64_t extremity, uint64_t* uniqueNeighbor) const
+{
+    const uint64_t *it, *end;
+    links(extremity, it, end);
+    unsigned int degree = 0;
+    for (; it != end; it++)
+    {
+        ExtremityInfo li(*it);
+        if (_graph.unitigs_deleted[li.unitig])
+            continue;
+        degree++;
+        if (uniqueNeighbor)
+            *uniqueNeighbor = (li.unitig << 1) | (li.pos == UNITIG_END ? 1 : 0); // pos is the side of the neighbor that faces us
+    }
+    return degree;
+}
+
+/* groups unitigs into chains (maximal non-branching paths of unitigs), and aggregates length/abundance/ends per chain */
+template<size_t span>
+void UnitigSimplifications<span>::buildChains ()
+{
+    const std::vector<bool>& deleted = _graph.unitigs_deleted;
+
+    // an extremity is linked to the rest of its chain when it has a single neighbor that has itself a single neighbor
+    auto chainLink = [&] (uint64_t extremity, uint64_t& neighbor) -> bool
+    {
+        return liveDegree(extremity, &neighbor) == 1 && (neighbor >> 1) != (extremity >> 1) && liveDegree(neighbor) == 1;
+    };
+
+    unionFindCompact uf (nbUnitigs);
+
+    iterateUnitigs (nbUnitigs, _nbCores, [&] (uint64_t u)
+    {
+        if (deleted[u]) return;
+        uint64_t neighbor;
+        for (uint64_t side = 0; side < 2; side++)
+            if (chainLink((u << 1) | side, neighbor))
+                uf.union_(u, neighbor >> 1);
+    });
+
+    uf.flatten();
+    _chain.swap(uf.mData);
+
+    _chainKmers.assign(nbUnitigs, 0);
+    _chainAbundance.assign(nbUnitigs, 0);
+    _chainEnds.assign(2 * nbUnitigs, NO_EXTREMITY);
+
+    unsigned int k = _graph.getKmerSize();
+
+    iterateUnitigs (nbUnitigs, _nbCores, [&] (uint64_t u)
+    {
+        if (deleted[u]) return;
+        uint64_t root = _chain[u];
+        uint32_t nbKmers = _graph.internal_get_unitig_length(u) - k + 1;
+        __sync_fetch_and_add (&_chainKmers[root], nbKmers);
+        __sync_fetch_and_add (&_chainAbundance[root], (uint64_t)(_graph.unitigs_mean_abundance[u] * nbKmers * ABUNDANCE_FIXED_POINT));
+
+        uint64_t neighbor;
+        for (uint64_t side = 0; side < 2; side++)
+        {
+            uint64_t extremity = (u << 1) | side;
+            if (chainLink(extremity, neighbor))
+                continue;
+            // a (non-circular) chain has exactly two such extremities
+            if (!__sync_bool_compare_and_swap (&_chainEnds[2*root], NO_EXTREMITY, extremity))
+                _chainEnds[2*root + 1] = extremity;
+        }
+    });
+}
+
+template<size_t span>
+double UnitigSimplifications<span>::chainMeanAbundance (uint64_t root) const
+{
+    return (_chainAbundance[root] / ABUNDANCE_FIXED_POINT) / _chainKmers[root];
+}
+
+/* in nucleotides */
+template<size_t span>
+unsigned int UnitigSimplifications<span>::chainLength (uint64_t root) const
+{
+    return _chainKmers[root] + _graph.getKmerSize() - 1;
+}
+
+/* unitig-level version of Simplifications::satisfyRCTC neighbors coverage:
+ * for each junction the extremity is connected to, mean abundance of the other chains that meet at that junction */
+template<size_t span>
+double UnitigSimplifications<span>::neighborsMeanAbundance (uint64_t extremity, uint64_t excludedRoot) const
+{
+    double meanNeighborsCoverage = 0;
+    unsigned int nbJunctions = 0;
+
+    const uint64_t *it, *end;
+    links(extremity, it, end);
+    for (; it != end; it++)
+    {
+        ExtremityInfo li(*it);
+        if (_graph.unitigs_deleted[li.unitig])
+            continue;
+
+        // the junction is the extremity of the neighbor facing us: chains there are the neighbor's own chain, and the chains of its other neighbors
+        double coverage = 0;
+        unsigned int nbChains = 0;
+        if (_chain[li.unitig] != excludedRoot)
+        {
+            coverage += chainMeanAbundance(_chain[li.unitig]);
+            nbChains++;
+        }
+
+        const uint64_t *it2, *end2;
+        links((li.unitig << 1) | (li.pos == UNITIG_END ? 1 : 0), it2, end2);
+        for (; it2 != end2; it2++)
+        {
+            ExtremityInfo li2(*it2);
+            if (_graph.unitigs_deleted[li2.unitig] || _chain[li2.unitig] == excludedRoot)
+                continue;
+            coverage += chainMeanAbundance(_chain[li2.unitig]);
+            nbChains++;
+        }
+
+        if (nbChains > 0)
+        {
+            meanNeighborsCoverage += coverage / nbChains;
+            nbJunctions++;
+        }
+    }
+
+    if (nbJunctions > 0)
+        meanNeighborsCoverage /= nbJunctions;
+    return meanNeighborsCoverage;
+}
+
+/* deletes all unitigs of the marked chains, returns the number of chains */
+template<size_t span>
+unsigned long UnitigSimplifications<span>::deleteChains (NodesBitmap& roots)
+{
+    unsigned long nbChains = 0;
+    // std::vector<bool> can't be written concurrently, and this is just a linear scan anyway
+    for (uint64_t u = 0; u < nbUnitigs; u++)
+    {
+        if (_graph.unitigs_deleted[u] || !roots[_chain[u]])
+            continue;
+        _graph.unitigs_deleted[u] = true;
+        if (_chain[u] == u)
+            nbChains++;
+    }
+    return nbChains;
+}
+
+/* a tip is a chain connected on one side only, that is short, or short-ish and much less covered than what it's connected to */
+template<size_t span>
+unsigned long UnitigSimplifications<span>::removeTips()
+{
+    buildChains();
+
+    unsigned int k = _graph.getKmerSize();
+    unsigned int maxTipLengthTopological = (unsigned int)((float)k * _tipLen_Topo_kMult);
+    unsigned int maxTipLengthRCTC        = (unsigned int)(k * _tipLen_RCTC_kMult);
+
+    NodesBitmap toDelete (nbUnitigs);
+
+    iterateUnitigs (nbUnitigs, _nbCores, [&] (uint64_t u)
+    {
+        if (_graph.unitigs_deleted[u] || _chain[u] != u || _chainEnds[2*u] == NO_EXTREMITY)
+            return;
+
+        uint64_t e0 = _chainEnds[2*u], e1 = _chainEnds[2*u + 1];
+        bool connected0 = liveDegree(e0) > 0, connected1 = liveDegree(e1) > 0;
+        if (connected0 == connected1) // isolated, or not a tip
+            return;
+
+        unsigned int length = chainLength(u);
+        bool isShortTopological = length <= maxTipLengthTopological;
+        bool isShortRCTC        = length <= maxTipLengthRCTC;
+
+        bool isTip = isShortTopological ||
+            (isShortRCTC && neighborsMeanAbundance(connected0 ? e0 : e1, u) > _tipRCTCcutoff * chainMeanAbundance(u));
+
+        if (isTip)
+            toDelete.set(u);
+    });
+
+    _nbTipRemovalPasses++;
+    return deleteChains(toDelete);
+}
+
+/* a bulge is a chain that has the same two neighbors as other chains (parallel paths);
+ * all but the most covered of them are removed */
+template<size_t span>
+unsigned long UnitigSimplifications<span>::removeBulges()
+{
+    buildChains();
+
+    unsigned int k = _graph.getKmerSize();
+    unsigned int maxBulgeLength = std::max((unsigned int)((double)k * _bulgeLen_kMult), (unsigned int)(k + _bulgeLen_kAdd));
+
+    NodesBitmap toDelete (nbUnitigs);
+
+    // both ends of the chain have a single neighbor, returned in a and b
+    auto isCandidate = [&] (uint64_t root, uint64_t& a, uint64_t& b) -> bool
+    {
+        if (_chainEnds[2*root] == NO_EXTREMITY)
+            return false;
+        return liveDegree(_chainEnds[2*root], &a) == 1 && liveDegree(_chainEnds[2*root + 1], &b) == 1 && a != b;
+    };
+
+    iterateUnitigs (nbUnitigs, _nbCores, [&] (uint64_t u)
+    {
+        uint64_t a, b;
+        if (_graph.unitigs_deleted[u] || _chain[u] != u || !isCandidate(u, a, b))
+            return;
+        if (_chain[a >> 1] == u || _chain[b >> 1] == u)
+            return;
+
+        unsigned int length = chainLength(u);
+        if (length > maxBulgeLength)
+            return;
+        unsigned int maxAltLength = std::max((unsigned int)(length * 1.1), length + 3); // following SPAdes, as in Simplifications
+
+        // the alternative paths are the other chains attached to a that also lead to b
+        uint64_t best = u;
+        double bestCoverage = chainMeanAbundance(u);
+
+        const uint64_t *it, *end;
+        links(a, it, end);
+        for (; it != end; it++)
+        {
+            ExtremityInfo li(*it);
+            if (_graph.unitigs_deleted[li.unitig])
+                continue;
+            uint64_t other = _chain[li.unitig], a2, b2;
+            if (other == u || !isCandidate(other, a2, b2))
+                continue;
+            if (! ((a2 == a && b2 == b) || (a2 == b && b2 == a)))
+                continue;
+            if (chainLength(other) > maxAltLength)
+                continue;
+            double coverage = chainMeanAbundance(other);
+            if (coverage > bestCoverage || (coverage == bestCoverage && other < best))
+            {
+                best = other;
+                bestCoverage = coverage;
+            }
+        }
+
+        // the most covered chain is never removed, so the graph stays connected
+        if (best != u && chainMeanAbundance(u) <= bestCoverage * _bulgeAltPath_covMult)
+            toDelete.set(u);
+    });
+
+    _nbBulgeRemovalPasses++;
+    return deleteChains(toDelete);
+}
+
+/* an erroneous connection is a short chain connected on both sides, much less covered than the chains around it */
+template<size_t span>
+unsigned long UnitigSimplifications<span>::removeErroneousConnections()
+{
+    buildChains();
+
+    unsigned int k = _graph.getKmerSize();
+    unsigned int maxECLength = (unsigned int)((float)k * _ecLen_kMult);
+
+    NodesBitmap toDelete (nbUnitigs);
+
+    iterateUnitigs (nbUnitigs, _nbCores, [&] (uint64_t u)
+    {
+        if (_graph.unitigs_deleted[u] || _chain[u] != u || _chainEnds[2*u] == NO_EXTREMITY)
+            return;
+
+        uint64_t e0 = _chainEnds[2*u], e1 = _chainEnds[2*u + 1];
+        if (liveDegree(e0) == 0 || liveDegree(e1) == 0)
+            return;
+
+        if (chainLength(u) > maxECLength)
+            return;
+
+        double pathMeanAbundance = chainMeanAbundance(u);
+        bool isRCTC = neighborsMeanAbundance(e0, u) > _ecRCTCcutoff * pathMeanAbundance ||
+                      neighborsMeanAbundance(e1, u) > _ecRCTCcutoff * pathMeanAbundance;
+
+        if (isRCTC)
+            toDelete.set(u);
+    });
+
+    _nbECRemovalPasses++;
+    return deleteChains(toDelete);
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif
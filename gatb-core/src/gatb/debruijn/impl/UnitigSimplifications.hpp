@@ -0,0 +1,109 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, D.Lavenier, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef _GATB_GRAPH_UNITIG_SIMPLIFICATION_HPP_
+#define _GATB_GRAPH_UNITIG_SIMPLIFICATION_HPP_
+
+/********************************************************************************/
+
+#include <gatb/debruijn/impl/GraphUnitigs.hpp>
+#include <vector>
+#include <string>
+
+/********************************************************************************/
+namespace gatb {  namespace core {  namespace debruijn {  namespace impl {
+/********************************************************************************/
+
+/** Unitig-level counterpart of Simplifications, for GraphUnitigs only.
+ *
+ * Simplifications walks simple paths node by node (simplePathLongest_avance) for each candidate;
+ * here, tips, bulges and erroneous connections are decided directly from the unitig records
+ * (length, mean abundance, incoming/outcoming links), in a few parallel passes over unitig ids per round:
+ *  - unitigs that are connected by a non-branching link are grouped into chains (union-find),
+ *    a chain is what Simplifications calls a simple path;
+ *  - chain length and mean abundance are aggregated per chain;
+ *  - each chain is tested for being a tip/bulge/EC using the same thresholds as Simplifications.
+ *
+ * Decisions of a pass are taken on the graph as it was at the beginning of the pass, then applied at once.
+ * Once everything is done, links to deleted unitigs are removed from the navigational vectors (compaction).
+ *
+ * Limitation: unitig ids are stored on 32 bits in the union-find.
+ */
+template<size_t span>
+class UnitigSimplifications
+{
+public:
+
+    UnitigSimplifications (GraphUnitigsTemplate<span> * graph, int nbCores, bool verbose = false);
+
+    void simplify(); // perform rounds of all simplifications, then compact the graph
+
+    unsigned long removeTips();
+    unsigned long removeBulges();
+    unsigned long removeErroneousConnections();
+
+    int _nbTipRemovalPasses;
+    int _nbBulgeRemovalPasses;
+    int _nbECRemovalPasses;
+
+    std::string tipRemoval, bulgeRemoval, ECRemoval;
+    bool _doTipRemoval, _doBulgeRemoval, _doECRemoval;
+
+    /* same parameters (and same defaults) as Simplifications */
+    double _tipLen_Topo_kMult;
+    double _tipLen_RCTC_kMult;
+    double _tipRCTCcutoff;
+
+    double       _bulgeLen_kMult;
+    unsigned int _bulgeLen_kAdd;
+    double       _bulgeAltPath_covMult;
+
+    double _ecLen_kMult;
+    double _ecRCTCcutoff;
+
+protected:
+
+    GraphUnitigsTemplate<span>& _graph;
+    int _nbCores;
+    bool _verbose;
+    uint64_t nbUnitigs;
+    uint64_t cutoffEvents;
+
+    /* per-pass chain information, indexed by unitig id (only meaningful for chain roots, except _chain) */
+    std::vector<uint32_t> _chain;        // chain root of each unitig
+    std::vector<uint32_t> _chainKmers;   // number of kmers in the chain
+    std::vector<uint64_t> _chainAbundance; // sum of kmer abundances in the chain, in fixed point
+    std::vector<uint64_t> _chainEnds;    // 2 per root: extremities of the chain that aren't linked to the rest of the chain
+
+    /* an extremity is (unitig << 1 | side), side 0 being the unitig beginning (incoming links) and 1 the end (outcoming links) */
+    void links (uint64_t extremity, const uint64_t*& begin, const uint64_t*& end) const;
+    unsigned int liveDegree (uint64_t extremity, uint64_t* uniqueNeighbor = 0) const;
+
+    void   buildChains ();
+    double chainMeanAbundance (uint64_t root) const;
+    unsigned int chainLength (uint64_t root) const;
+    double neighborsMeanAbundance (uint64_t extremity, uint64_t excludedRoot) const;
+    unsigned long deleteChains (NodesBitmap& roots);
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif
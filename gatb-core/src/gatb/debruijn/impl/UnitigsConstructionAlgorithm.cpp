@@ -100,6 +100,8 @@ void UnitigsConstructionAlgorithm<span>::execute ()
     bool edge_km_representation = getInput()->getInt(STR_EDGE_KM_REPRESENTATION);
     bool all_abundance_counts   = getInput()->get(STR_ALL_ABUNDANCE_COUNTS);
    
+    int max_memory = getInput()->get(STR_MAX_MEMORY) ? getInput()->getInt(STR_MAX_MEMORY) : 0;
+
     int nb_glue_partitions = 0;
     if (getInput()->get("-nb-glue-partitions"))
         nb_glue_partitions = getInput()->getInt("-nb-glue-partitions");
@@ -109,7 +111,7 @@ void UnitigsConstructionAlgorithm<span>::execute ()
         std::cout << "Uh. Unitigs graph construction called with nb_threads " << nb_threads << " but dispatcher has nbThreads " << nbThreads << std::endl;
 
     if (do_bcalm) bcalm2<span>(&_storage, unitigs_filename, kmerSize, abundance, minimizerSize, nbThreads, minimizer_type,       verbose); 
-    if (do_bglue) bglue<span> (&_storage, unitigs_filename, kmerSize, nb_glue_partitions,       nbThreads, all_abundance_counts, verbose);
+    if (do_bglue) bglue<span> (&_storage, unitigs_filename, kmerSize, nb_glue_partitions,       nbThreads, all_abundance_counts, verbose, max_memory);
     if (do_links) link_tigs<span>(unitigs_filename, kmerSize, nbThreads, nb_unitigs, verbose, edge_km_representation);
 
     /** We gather some statistics. */
@@ -18,6 +18,7 @@
 *****************************************************************************/
 
 #include <gatb/kmer/impl/Configuration.hpp>
+#include <gatb/kmer/impl/MinimizerOrder.hpp>
 #include <gatb/system/api/IMemory.hpp>
 
 /********************************************************************************/
@@ -73,13 +74,14 @@ Properties Configuration::getProperties() const
     result.add (1, "estimated_sequence_volume",   "%ld", _estimateSeqTotalSize / system::MBYTE);
     result.add (1, "estimated_kmers_number",      "%ld", _kmersNb);
     result.add (1, "estimated_kmers_volume",      "%ld", _volume);
+    if (_estimatedDistinctKmersNb > 0)  {  result.add (1, "estimated_distinct_kmers_number", "%ld", _estimatedDistinctKmersNb);  }
     result.add (1, "max_disk_space",    "%ld", _max_disk_space);
     result.add (1, "max_memory",        "%ld", _max_memory);
     result.add (1, "nb_passes",         "%d",  _nb_passes);
     result.add (1, "nb_partitions",     "%d",  _nb_partitions);
     result.add (1, "nb_bits_per_kmer",  "%d",  _nb_bits_per_kmer);
     result.add (1, "nb_cores",          "%d",  _nbCores);
-    result.add (1, "minimizer_type",    "%s",  (_minimizerType == 0) ? "lexicographic (kmc2 heuristic)" : "frequency");
+    result.add (1, "minimizer_type",    "%s",  MinimizerOrder::getName (_minimizerType));
     result.add (1, "repartition_type",  "%s",  (_repartitionType == 0) ? "unordered" : "ordered");
 
     result.add (1, "nb_cores_per_partition",     "%d",  _nbCores_per_partition);
@@ -47,7 +47,7 @@ public:
       _nbCores(0), _nb_partitions_in_parallel(0), _abundanceUserNb(0), _storage_type(tools::storage::impl::STORAGE_HDF5) ,
       _isComputed(false), _nbCores_per_partition(0),
       _estimateSeqNb(0), _estimateSeqTotalSize(0), _estimateSeqMaxSize(0),
-      _available_space(0), _volume(0), _kmersNb(0), _nb_passes(0), _nb_partitions(0), _nb_bits_per_kmer(0), _nb_banks(0) {}
+      _available_space(0), _volume(0), _kmersNb(0), _estimatedDistinctKmersNb(0), _nb_passes(0), _nb_partitions(0), _nb_bits_per_kmer(0), _nb_banks(0) {}
 
     /****************************************/
     /**             PROVIDED                */
@@ -90,6 +90,9 @@ public:
     u_int64_t   _volume;
     u_int64_t   _kmersNb;
 
+    /** Estimated number of distinct kmers (see RepartitorAlgorithm), 0 if unknown. */
+    u_int64_t   _estimatedDistinctKmersNb;
+
     u_int32_t   _nb_passes;
     u_int32_t   _nb_partitions;
 
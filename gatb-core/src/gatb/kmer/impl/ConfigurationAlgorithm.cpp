@@ -18,11 +18,11 @@
 *****************************************************************************/
 
 #include <gatb/kmer/impl/ConfigurationAlgorithm.hpp>
+#include <gatb/kmer/impl/MinimizerOrder.hpp>
 #include <gatb/system/impl/System.hpp>
 #include <gatb/tools/collections/impl/OAHash.hpp>
 #include <gatb/tools/misc/api/StringsRepository.hpp>
 #include <gatb/tools/misc/impl/Tokenizer.hpp>
-#include <gatb/kmer/impl/LinearCounter.hpp>
 
 #include <cmath>
 
@@ -52,131 +52,6 @@ using namespace gatb::core::tools::misc::impl;
 
 #define DEBUG(a)  //printf a
 
-/*********************************************************************
-** METHOD  :
-** PURPOSE :
-** INPUT   :
-** OUTPUT  :
-** RETURN  :
-** REMARKS :
-*********************************************************************/
-
-// estimated the number of distinct kmers in a dataset
-// wrapper around a Linear Counter. Adapted from Kmergenie code.
-// why not a hyperloglog? it seems that the transition from the 32bit-hash initial implementation to 64bits, and supporting billions of elements, is nontrivial, so i didn't bother
-// probably deserves to be in its own file
-template<size_t span>
-class EstimateNbDistinctKmers
-{
-public:
-
-    /** Shortcut. */
-    typedef typename Kmer<span>::Type  Type;
-    typedef typename Kmer<span>::ModelDirect     ModelDirect;
-    typedef typename Kmer<span>::ModelCanonical  ModelCanonical;
-#ifdef NONCANONICAL 
-    typedef typename Kmer<span>::template ModelMinimizer <ModelDirect>   Model;
-#else
-    typedef typename Kmer<span>::template ModelMinimizer <ModelCanonical>   Model;
-#endif
-    typedef typename Model::Kmer                        KmerType;
-
-    /** */
-    void estimate()
-    {
-        nb_distinct_kmers =(unsigned long)( (float)(linearCounter->count( )) * ((float)nbKmersTotal / (float)nbProcessedKmers)); // dubious linear extrapolation, that's all I got
-
-        abs_error = abs((long)(nb_distinct_kmers-previous_nb_distinct_kmers));
-
-        previous_nb_distinct_kmers = nb_distinct_kmers;
-    }
-
-    /** */
-    void operator() (Sequence& sequence)
-    {
-        /** We build the kmers from the current sequence. */
-        if (model.build (sequence.getData(), kmers) == false)  {  throw "reached EOF"; return; }
-
-        /** We loop over the kmers. */
-        for (size_t i=0; i<kmers.size(); i++)
-        {
-            linearCounter->add((kmers[i].value()));
-
-
-            // heuristics to stop early, i found that it's inaccurate with low coverage (e.g. on dsk/test/FiftyK.fastq)
-            /*
-            if (nbProcessedReads % eval_every_N_reads == 0 )
-            {
-
-                // let's see if the estimation converges..
-                // the following stopping condition will grossly over-estimate the number of distinct kmers
-                // but I expect the correct result to be in the same order of magnitude
-                // and better to overestimate than underestimate (for both dsk and kmergenie)
-                   estimate();
-                   bool debug = true;
-                   if (debug)
-                       printf("linear estimator at %ld kmers, number of distinct kmers estimated now: %ld, abs error: %ld\n",nbProcessedKmers, nb_distinct_kmers, abs_error);
-                   if (abs_error < previous_nb_distinct_kmers/20) // 5% error
-                   {
-                       throw "LinearCounter converged"; // well, "converged" is a big word
-                       return;
-                   }
-                   if (!linearCounter->is_accurate())
-                   {
-                   printf("LinearCounter is inaccurate";
-                   return;
-                   }
-
-            }*/
-
-        }
-        nbProcessedKmers += kmers.size();
-        nbProcessedReads++;
-        //if (nbProcessedReads % 100000 == 0) printf("nb: %ld\n",nbProcessedReads);
-
-        // disabled progress
-        //if (nbCurProgressKmers > 500000)   {  _progress.inc (nbCurProgressKmers);  nbCurProgressKmers = 0;  }
-    }
-
-    EstimateNbDistinctKmers (Model& model, u_int32_t max_memory, unsigned long nb_kmers_total, tools::dp::IteratorListener* progress)
-        : model(model),  eval_every_N_reads(10000000),   nbKmersTotal(nb_kmers_total),
-        nbProcessedKmers(0), nbCurProgressKmers(0), previous_nb_distinct_kmers(0), nbProcessedReads(0), abs_error(0)
-        //, _progress  (progress,System::thread().newSynchronizer())
-    {
-        unsigned long size_linearCounter; // (in bits)
-        /* let's set it to just use half of all memory available at most, ok? this isn't very robust for huge dataset, so to be tested*/
-        /* if it's a tiny dataset, let's set it to total number of kmers */
-        size_linearCounter = std::min( nb_kmers_total, (unsigned long) (max_memory*8*1024*1024/2) );
-        linearCounter =  new LinearCounter<span>(size_linearCounter);
-    }
-
-    unsigned long getEstimation()
-    {
-        estimate();
-        // soo.. if it's not accurate, let's assume we have a hugeload of kmers, and let's be safe, we return the total number of kmers
-        if (!linearCounter->is_accurate())
-        {
-            cout << "Warning: linear counter was not accurate, returning worst-case estimation of number of distinct kmers";
-            return nbKmersTotal;
-        }
-        return nb_distinct_kmers;
-    }
-
-private:
-
-    /** Local resources. */
-    Model&    model;
-    unsigned long nbProcessedReads, nbProcessedKmers;
-    unsigned long nbCurProgressKmers;
-    unsigned long nbKmersTotal;
-    unsigned long abs_error;
-    vector<KmerType> kmers;
-    LinearCounter<span> *linearCounter;
-    int eval_every_N_reads;
-    unsigned long previous_nb_distinct_kmers, nb_distinct_kmers;
-};
-
-
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -197,6 +72,8 @@ ConfigurationAlgorithm<span>::ConfigurationAlgorithm (bank::IBank* bank, IProper
     _config._repartitionType    = input->getInt (STR_REPARTITION_TYPE);
     _config._minimizerType      = input->getInt (STR_MINIMIZER_TYPE);
 
+    if (_config._minimizerType > MinimizerOrder::DECYCLING)  {  throw system::Exception ("Bad minimizer type %d", _config._minimizerType);  }
+
     parse (input->getStr (STR_SOLIDITY_KIND), _config._solidityKind);
 
     _config._max_disk_space     = input->getInt (STR_MAX_DISK);
@@ -215,7 +92,9 @@ ConfigurationAlgorithm<span>::ConfigurationAlgorithm (bank::IBank* bank, IProper
     _config._nb_bits_per_kmer = Type::getSize();
     
     std::string storage_type = input->getStr(STR_STORAGE_TYPE);
-    _config._storage_type = (storage_type == "hdf5") ? tools::storage::impl::STORAGE_HDF5 : tools::storage::impl::STORAGE_FILE;
+    _config._storage_type = (storage_type == "hdf5")   ? tools::storage::impl::STORAGE_HDF5 :
+                            (storage_type == "packed") ? tools::storage::impl::STORAGE_PACKED_FILE :
+                                                         tools::storage::impl::STORAGE_FILE;
 }
 
 /*********************************************************************
@@ -355,46 +234,15 @@ void ConfigurationAlgorithm<span>::execute ()
     size_t max_open_files = System::file().getMaxFilesNumber() / 2;
 
 
-    if (_config._storage_type == tools::storage::impl::STORAGE_FILE)
+    if (_config._storage_type == tools::storage::impl::STORAGE_FILE || _config._storage_type == tools::storage::impl::STORAGE_PACKED_FILE)
     {
         std::cout << "using less max_open_open files (" << max_open_files << "), by 3x, due to storage file setting" << std::endl;
         max_open_files /= 3; // will need to open twice in STORAGE_FILE instead of HDF5, so this adjustment is needed. needs to be fixed later by putting partitions inside the same file. but i'd rather not do it in the current messy collection/group/partition hdf5-inspired system. overall, that's a FIXME
     }
 
-#if 0
-    /* disabled by default; this was an experiment */
-    float est_volume_distinct_ratio;
-    if (_flagEstimateNbDistinctKmers)
-    {
-        /* we estimate the volume of distinct kmers vs total number of kmers.
-         * we store it in the variable "est_volume_distinct_ratio"
-         * to compute it, we need a linear counter, let's call it now */
-
-        TIME_INFO (getTimeInfo(), "estimate_distinct_kmers");
-        Iterator<Sequence>* itSeq = _bank->iterator();
-        LOCAL (itSeq);
-
-        //_progress->setMessage (progressFormat0); // not touching progress here anymore
-        Model model (_kmerSize, _minim_size);
-        EstimateNbDistinctKmers<span> estimate_nb_distinct_kmers_function(model, _max_memory, kmersNb, _progress);
-
-        /** We launch the iteration of the sequences iterator with the created functors. */
-        try {
-            itSeq->iterate (estimate_nb_distinct_kmers_function);
-        }
-        catch (const char* except)
-        {
-
-        }
-        _estimatedDistinctKmerNb = estimate_nb_distinct_kmers_function.getEstimation();
-        est_volume_distinct_ratio = (float) _estimatedDistinctKmerNb / (float)kmersNb;
-        //est_volume_distinct_ratio = 1; // for debug
-        /* est_volume_distinct_ratio == 1 mean that we guarantee worst case the memory usage,
-           the value mean that, on average, a k-mer will be seen 'est_volume_distinct_ratio' times */
-        // if wrongly estimated, the error 'OAHash: max rehashes..' can happen
-        printf ("LinearCounter done, estimated %ld number of distinct kmers, ratio to total number of kmers: %.2f\n", (long)_estimatedDistinctKmerNb, est_volume_distinct_ratio);
-    }
-#endif
+    /** Note: the number of distinct kmers is not known here; it is estimated afterwards, during the
+     * sampling of the RepartitorAlgorithm (see Configuration::_estimatedDistinctKmersNb). The sizes
+     * below rely on the total number of kmers, since the partitions hold every kmer occurrence. */
     u_int64_t volume_per_pass;
     do  {
 
@@ -0,0 +1,210 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file MinimizerOrder.hpp
+ *  \brief Orders of the mmers used for choosing the minimizers
+ */
+
+#ifndef _GATB_CORE_KMER_IMPL_MINIMIZER_ORDER_HPP_
+#define _GATB_CORE_KMER_IMPL_MINIMIZER_ORDER_HPP_
+
+/********************************************************************************/
+
+#include <gatb/system/api/types.hpp>
+#include <gatb/tools/math/NativeInt64.hpp>
+
+#include <vector>
+#include <cmath>
+
+/********************************************************************************/
+namespace gatb      {
+namespace core      {
+namespace kmer      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Orders of the mmers given by a table of ranks.
+ *
+ * Apart from the lexicographic order, the minimizers are chosen with a table of 4^m ranks:
+ * the minimizer of a kmer is the mmer of lowest rank, the ties being broken by the mmer
+ * values (see ComparatorMinimizerFrequencyOrLex). This class fills such tables for the orders
+ * that don't depend on the data; the frequency order is computed by RepartitorAlgorithm.
+ *
+ * The ranks are below 2^31 and the largest mmer (GG...G, the default minimizer value) has the
+ * largest rank, so that any other mmer is a better minimizer.
+ */
+class MinimizerOrder
+{
+public:
+
+    /** Values of the minimizer type option. */
+    enum Type
+    {
+        /** lexicographic, without mmers having AA inside */
+        LEXICOGRAPHIC = 0,
+        /** increasing frequencies in a sample of the reads */
+        FREQUENCY     = 1,
+        /** random order given by a hash of the mmers */
+        RANDOM        = 2,
+        /** mmers of a minimum decycling set first, then the others, random order inside each part */
+        DECYCLING     = 3
+    };
+
+    /** Name of a minimizer type.
+     * \param[in] type : the minimizer type
+     * \return the name. */
+    static const char* getName (size_t type)
+    {
+        switch (type)
+        {
+            case LEXICOGRAPHIC: return "lexicographic (kmc2 heuristic)";
+            case FREQUENCY:     return "frequency";
+            case RANDOM:        return "random";
+            case DECYCLING:     return "decycling set";
+            default:            return "unknown";
+        }
+    }
+
+    /** Tells whether a minimizer type uses a table of ranks computed without the data.
+     * \param[in] type : the minimizer type
+     * \return true for the random and decycling orders. */
+    static bool isPrecomputed (size_t type)  { return type == RANDOM || type == DECYCLING; }
+
+    /** Fill the table of ranks of an order computed without the data.
+     * \param[in] type : RANDOM or DECYCLING
+     * \param[in] m : size of the mmers
+     * \param[out] ranks : table of 4^m ranks */
+    static void compute (size_t type, size_t m, uint32_t* ranks)
+    {
+        if (type == DECYCLING)  { computeDecycling (m, ranks); }
+        else                    { computeRandom    (m, ranks); }
+    }
+
+    /** Random order: the ranks are given by a hash of the mmers, which spreads the minimizers
+     * uniformly, unlike the lexicographic order that favors the mmers starting by A's.
+     * \param[in] m : size of the mmers
+     * \param[out] ranks : table of 4^m ranks */
+    static void computeRandom (size_t m, uint32_t* ranks)
+    {
+        u_int64_t rg = (u_int64_t)1 << (2*m);
+
+        for (u_int64_t x=0; x<rg; x++)  {  ranks[x] = hashRank (x);  }
+
+        ranks[rg-1] = MAX_RANK;
+    }
+
+    /** Decycling order: the mmers of the minimum decycling set of Mykkeltveit come first. Any
+     * cycle of the de Bruijn graph of order m goes through this set, so a long enough window
+     * always contains one of its mmers: the set plays the role of a universal hitting set and
+     * gives a lower density of minimizers than a random order, ie. fewer and longer superkmers
+     * (see Pellow et al., "Efficient minimizer orders for large values of k using minimum
+     * decycling sets", 2023). The set has one mmer per necklace (class of mmers equal up to a
+     * rotation), ie. about 4^m/m mmers.
+     * \param[in] m : size of the mmers
+     * \param[out] ranks : table of 4^m ranks */
+    static void computeDecycling (size_t m, uint32_t* ranks)
+    {
+        u_int64_t rg = (u_int64_t)1 << (2*m);
+
+        DecyclingSet set (m);
+
+        for (u_int64_t x=0; x<rg; x++)
+        {
+            uint32_t r = hashRank (x) >> 1;
+            ranks[x] = set.contains (x) ? r : (r | ((uint32_t)1 << 30));
+        }
+
+        ranks[rg-1] = MAX_RANK;
+    }
+
+    /** \brief Minimum decycling set of Mykkeltveit.
+     *
+     * The mmer x = x_0...x_{m-1} has the weight w(x) = sum x_i.sin(2.pi.i/m); the set contains
+     * the mmers x of positive weight whose rotation x_{m-1}x_0...x_{m-2} has a non positive
+     * weight, and for the necklaces whose mmers all have a null weight, their smallest mmer.
+     */
+    class DecyclingSet
+    {
+    public:
+
+        /** Constructor.
+         * \param[in] m : size of the mmers */
+        DecyclingSet (size_t m) : _m(m), _sin(m)
+        {
+            for (size_t i=0; i<m; i++)  {  _sin[i] = std::sin (2 * M_PI * i / m);  }
+        }
+
+        /** Tells whether a mmer belongs to the set.
+         * \param[in] x : value of the mmer
+         * \return true if the mmer is in the set. */
+        bool contains (u_int64_t x) const
+        {
+            double w = weight (x);
+
+            if (w >  epsilon())  {  return weight (rotate (x)) <= epsilon();  }
+            if (w < -epsilon())  {  return false;  }
+
+            /** Null weight: we keep the smallest mmer of the necklace if all the weights are null. */
+            u_int64_t y = x;
+            for (size_t i=1; i<_m; i++)
+            {
+                y = rotate (y);
+                if (y < x || std::fabs (weight (y)) > epsilon())  { return false; }
+            }
+            return true;
+        }
+
+    private:
+
+        /** The weights are sums of at most m terms of magnitude 3 at most: a null weight has a
+         * rounding error far below this value, a non null one is far above. */
+        static double epsilon ()  { return 1e-6; }
+
+        /** The first nucleotide of the mmer is in the most significant bits. */
+        double weight (u_int64_t x) const
+        {
+            double w = 0;
+            for (size_t i=0; i<_m; i++)  {  w += ((x >> (2*(_m-1-i))) & 3) * _sin[i];  }
+            return w;
+        }
+
+        /** Moves the last nucleotide in first position. */
+        u_int64_t rotate (u_int64_t x) const  {  return (x >> 2) | ((x & 3) << (2*(_m-1)));  }
+
+        size_t              _m;
+        std::vector<double> _sin;
+    };
+
+private:
+
+    static const uint32_t MAX_RANK = 0x7FFFFFFF;
+
+    /** 31 bits from the hash of the mmer, below MAX_RANK. */
+    static uint32_t hashRank (u_int64_t x)
+    {
+        uint32_t r = (uint32_t) (tools::math::NativeInt64::wyhash64 (x, 0) >> 33);
+        return r == MAX_RANK ? r - 1 : r;
+    }
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_KMER_IMPL_MINIMIZER_ORDER_HPP_ */
@@ -39,6 +39,7 @@
 #include <gatb/tools/misc/api/Abundance.hpp>
 
 #include <gatb/tools/math/Integer.hpp>
+#include <gatb/tools/math/Kernels.hpp>
 
 #include <gatb/tools/storage/impl/Storage.hpp>
 
@@ -1037,31 +1038,19 @@ struct Kmer
             bool isModelCanonical = isModelCanonical_p != NULL;
             _defaultFast = isModelCanonical;
 
-			for(u_int64_t ii=0; ii< nbminims_total; ii++)
-			{
-				Type mmer;
-				mmer.setVal(ii);
-				
-				// if(!is_allowed(mmer.getVal(),minimizerSize)) mmer = _mask;
-				// if(!is_allowed(rev_mmer.getVal(),minimizerSize)) rev_mmer = _mask;
-				
-				if (isModelCanonical)
-				{
-					Type rev_mmer = revcomp(mmer, minimizerSize);
-					if(rev_mmer < mmer) mmer = rev_mmer;
-					
-					//may be cleaner with this
-					//if (_cmp (rev_mmer, mmer ) == true)
-					//	mmer = rev_mmer;
-				}
-				
-				//std:: cout << "ii " << ii << " is allowed " << is_allowed(mmer.getVal(),minimizerSize) <<  " mmer getval " << mmer.getVal() << " is model canonical " << isModelCanonical << std::endl;
-				
-				if (!is_allowed(mmer.getVal(),minimizerSize))
-					mmer = _mask;
-				
-				_mmer_lut[ii] = mmer;
-			}
+            /** The table is filled by blocks with the kernel selected for the CPU; it keeps for each
+             * mmer its canonical value (for a canonical model), or the mask if it is not allowed. */
+            u_int64_t block[1024];
+            for (u_int64_t ii=0; ii<nbminims_total; ii+=1024)
+            {
+                size_t nb = std::min<u_int64_t> (1024, nbminims_total - ii);
+
+                tools::math::Kernels::singleton().mmerTable (
+                    ii, nb, minimizerSize, isModelCanonical, _freq_order==0, _mask.getVal(), block
+                );
+
+                for (size_t j=0; j<nb; j++)  {  _mmer_lut[ii+j].setVal (block[j]);  }
+            }
 
             if (freq_order)
                 setMinimizersFrequency(freq_order);
@@ -1138,6 +1127,52 @@ struct Kmer
             }
         }
 
+        /** Buffer for the mmers of the sliding window used by 'build'; it can be reused from one call to another. */
+        typedef std::vector<Type> Window;
+
+        /** Build the successive kmers of a sequence with their minimizers, in one pass.
+         *
+         * The kmers are computed by the kmer model; each mmer of the sequence goes once through the mmers
+         * lookup table and is kept in a ring buffer holding the window of the current kmer. The minimizer is
+         * updated as in 'next', but when it goes out of the window, the new one is found by scanning the
+         * ring buffer instead of extracting again all the mmers of the kmer.
+         *
+         * Minimizers (values and positions) and valid status are the same as with 'iterate'; the 'changed'
+         * status tells whether the minimizer value differs from the one of the previous kmer.
+         *
+         * \param[in] data : the sequence of nucleotides.
+         * \param[out] kmers : the successive kmers built from the data object.
+         * \param[in] window : buffer for the sliding window of mmers.
+         * \return true if kmers have been extracted, false otherwise. */
+        bool build (tools::misc::Data& data, std::vector<Kmer>& kmers, Window& window) const
+        {
+            int32_t nbKmers = data.size() - this->getKmerSize() + 1;
+            if (nbKmers <= 0)  { return false; }
+
+            /** The ring buffer size is a power of two, so positions are mapped with a mask. */
+            size_t capacity = 1;
+            while (capacity < _nbMinimizers)  { capacity <<= 1; }
+
+            kmers.resize  (nbKmers);
+            window.resize (capacity);
+
+            /** The slider is given by reference since it keeps the state of the window from one kmer to the next. */
+            WindowSlider slider (*this, kmers, window);
+            _kmerModel.template iterate<WindowSlider&> (data, slider);
+
+            return true;
+        }
+
+        /** Build the successive kmers of a sequence with their minimizers (see above).
+         * \param[in] data : the sequence of nucleotides.
+         * \param[out] kmers : the successive kmers built from the data object.
+         * \return true if kmers have been extracted, false otherwise. */
+        bool build (tools::misc::Data& data, std::vector<Kmer>& kmers) const
+        {
+            Window window;
+            return build (data, kmers, window);
+        }
+
         /** Get the minimizer value of the provided kmer. Note that minimizers are supposed to be
          * of small sizes, so their values can fit a u_int64_t type.
          * \return the miminizer value as an integer. */
@@ -1214,41 +1249,77 @@ struct Kmer
 
         uint32_t *_freq_order;
 		
+        /* Functor for 'build': receives the kmers of the kmer model and slides the window of mmers.
+         * Attributes are copies of the model ones and are copied into locals for each kmer: the kmers and
+         * the mmers have the same type, so they would be read again after each store into the buffers. */
+        struct WindowSlider
+        {
+            const Comparator& cmp;
+            const Type*       lut;
+            Type              mask;
+            Type              defaultValue;
+            int32_t           nb;
+            int32_t           ringMask;
+            Kmer*             kmers;
+            Type*             window;
+            Type              best;
+            int32_t           bestPos;
+
+            WindowSlider (const ModelMinimizer& model, std::vector<Kmer>& kmers, Window& window)
+                : cmp(model._cmp), lut(model._mmer_lut), mask(model._mask), defaultValue(model._minimizerDefault.value()),
+                  nb(model._nbMinimizers), ringMask(window.size()-1), kmers(kmers.data()), window(window.data()),
+                  best(defaultValue), bestPos(-1)  {}
+
+            void operator() (const typename ModelType::Kmer& kmer, size_t idx)
+            {
+                /** Positions are positions in the sequence; the mmer at position p is at p&ringMask in the window. */
+                int32_t i = idx,  last = i + nb - 1;
+                Type    val = kmer.value(0);
+                Type    b   = best;
+                int32_t bp  = bestPos;
+
+                /** The first kmer gives the first mmers of the sequence, then each kmer gives its last mmer. */
+                if (i == 0)
+                {
+                    for (int32_t p=0; p<nb-1; p++)  {  window[p & ringMask] = lut[((val >> (2*(last-p))) & mask).getVal()];  }
+                }
+
+                Type mmer = lut[(val & mask).getVal()];
+                window[last & ringMask] = mmer;
+
+                if (i > 0 && cmp (mmer, b) == true)
+                {
+                    b = mmer;  bp = last;
+                }
+                else if (i == 0 || bp < i)
+                {
+                    /** Same scan as 'computeNewMinimizerOriginal', from the right. */
+                    b = defaultValue;  bp = -1;
+                    for (int32_t p=last; p>=i; p--)
+                    {
+                        if (cmp (window[p & ringMask], b) == true)  {  b = window[p & ringMask];  bp = p;  }
+                    }
+                }
+
+                best = b;  bestPos = bp;
+
+                Kmer& result = kmers[i];
+                static_cast<typename ModelType::Kmer&> (result) = kmer;
+
+                result._minimizer.set (b);
+                result._position = bp < 0 ? -1 : bp - i;
+                result._changed  = i==0 || b != kmers[i-1]._minimizer.value();
+            }
+        };
 
         /** Tells whether a minimizer is valid or not, in order to skip minimizers
          *  that are too frequent. */
-        bool is_allowed (uint32_t mmer, uint32_t len)
-		{
-			if (_freq_order) return true; // every minimizer is allowed in freq order
-			
-			u_int64_t  _mmask_m1  ;
-			u_int64_t  _mask_0101 ;
-			u_int64_t  _mask_ma1 ;
-			
-			//code to ban mmer with AA inside except if at the beginnning
-			// A C T G        00   01   10   11
-			_mmask_m1  = (1 << ((len-2)*2)) -1 ; //vire 2 premieres lettres m = 8  donne    00 00 11 11 11 11 11 11
-			_mask_0101 = 0x5555555555555555  ; //         01 01 01 01 01 01 01 01
-			_mask_ma1  = _mask_0101 & _mmask_m1;//        00 00 01 01 01 01 01 01
-			
-			u_int64_t a1 = mmer; //
-			a1 =   ~(( a1 )   | (  a1 >>2 ));  //
-			a1 =((a1 >>1) & a1) & _mask_ma1 ;  //
-			
-			if(a1 != 0) return false;
-			
-			// if ((mmer & 0x3f) == 0x2a)   return false;   // TTT suffix
-			// if ((mmer & 0x3f) == 0x2e)   return false;   // TGT suffix
-			// if ((mmer & 0x3c) == 0x28)   return false;   // TT* suffix
-			// for (uint32_t j = 0; j < len - 3; ++j)       // AA inside
-			//      if ((mmer & 0xf) == 0)  return false;
-			//      else                    mmer >>= 2;
-			// if (mmer == 0)               return false;   // AAA prefix
-			// if (mmer == 0x04)            return false;   // ACA prefix
-			// if ((mmer & 0xf) == 0)   return false;       // *AA prefix
-			
-			return true;
-		}
+        bool is_allowed (u_int64_t mmer, size_t len)
+        {
+            if (_freq_order) return true; // every minimizer is allowed in freq order
+
+            return tools::math::isAllowedMmer (mmer, len);
+        }
 		
         /** Returns the minimizer of the provided vector of mmers. */
         void computeNewMinimizerOriginal(Kmer& kmer) const
@@ -1333,6 +1404,7 @@ struct Kmer
     /************************************************************/
 	
 	//now with  vector containing the overlapping kmers of the superkmers (instead of reference to large external vector buffer)
+	//the kmers may also be a range of an external buffer (see setRange), which avoids copying them one by one
     class SuperKmer
     {
     public:
@@ -1349,7 +1421,7 @@ struct Kmer
         static const u_int64_t DEFAULT_MINIMIZER = 1000000000 ;
 
         SuperKmer (size_t kmerSize, size_t miniSize)
-            : minimizer(DEFAULT_MINIMIZER), kmerSize(kmerSize), miniSize(miniSize)
+            : minimizer(DEFAULT_MINIMIZER), kmerSize(kmerSize), miniSize(miniSize), _first(0), _size(0)
         {
 			_max_size_sk = 1000;
 			kmers.clear();
@@ -1361,11 +1433,11 @@ struct Kmer
         u_int64_t                minimizer;
 
         Kmer& operator[] (size_t idx)  {
-			return kmers[idx];
+			return _first[idx];
 		}
 
 		size_t size() const {
-			return kmers.size();
+			return _size;
 		}
 
         bool isValid() const { return minimizer != DEFAULT_MINIMIZER; }
@@ -1373,11 +1445,26 @@ struct Kmer
 		void addKmer(Kmer newkmer)
 		{
 			kmers.push_back(newkmer);
+			_first = &kmers[0];
+			_size  = kmers.size();
+		}
+
+		/** Use a range of an external buffer as the kmers of the superkmer; the buffer must
+		 * not change while the superkmer is used.
+		 * \param[in] first : first kmer of the range
+		 * \param[in] nb : number of kmers of the range */
+		void setRange (Kmer* first, size_t nb)
+		{
+			kmers.clear();
+			_first = first;
+			_size  = nb;
 		}
 		
 		void reset()
 		{
 			kmers.clear();
+			_first = 0;
+			_size  = 0;
 			//binrep.clear();
 			_sk_buffer_idx =0;
 		}
@@ -1466,7 +1553,7 @@ struct Kmer
 			//printf("insert superK %i  _sk_buffer_idx %i \n",kmers.size(),_sk_buffer_idx);
 			
 		//	cacheSuperkFile.insertSuperkmer(binrep.data(), binrep.size(), kmers.size(),  file_id);
-			cacheSuperkFile.insertSuperkmer(_sk_buffer, _sk_buffer_idx, kmers.size(),  file_id);
+			cacheSuperkFile.insertSuperkmer(_sk_buffer, _sk_buffer_idx, size(),  file_id);
 			
 		}
 		
@@ -1549,6 +1636,8 @@ struct Kmer
         size_t              kmerSize;
         size_t              miniSize;
         std::vector<Kmer>  kmers;
+        Kmer*              _first;
+        size_t             _size;
 		//std::vector<u_int8_t> binrep;
 		u_int8_t * _sk_buffer;
 		int _sk_buffer_idx;
@@ -20,6 +20,7 @@
 #include <gatb/kmer/impl/PartitionsCommand.hpp>
 #include <gatb/tools/collections/impl/OAHash.hpp>
 #include <gatb/tools/collections/impl/Hash16.hpp>
+#include <gatb/tools/collections/impl/KWayMerge.hpp>
 #include <gatb/tools/misc/impl/Stringify.hpp>
 
 
@@ -219,8 +220,6 @@ PartitionsByHashCommand<span>:: PartitionsByHashCommand (
 	{
 		typedef typename Kmer<span>::Type  Type;
 		typedef tools::misc::Abundance<Type> abundance_t;
-		typedef std::pair< int , Type> ptcf; //  id pointer , kmer value
-		struct ptcfcomp { bool operator() (ptcf l,ptcf r) { return ((r.second) < (l.second)); } } ;
 		
 	public:
 		TempCountFileMerger(size_t reduceTarget, int chunksize) :_reduceTarget(reduceTarget), _chunksize(chunksize),_idx(0)
@@ -229,13 +228,6 @@ PartitionsByHashCommand<span>:: PartitionsByHashCommand (
 		
 		std::vector<string>  mergeFiles(std::vector<string> filenames)
 		{
-			ptcf best_elem;
-			int best_p;
-			int current_ab = 0;
-			int previous_ab = 0;
-			Type current_kmer,previous_kmer;
-			
-			
 			while(filenames.size() > _reduceTarget)
 			{
 				
@@ -252,92 +244,20 @@ PartitionsByHashCommand<span>:: PartitionsByHashCommand (
 				
 				filenames.push_back(newfname);
 				
-				std::vector<Iterator<abundance_t>*> _tmpCountIterators;
-				
-				for(size_t ii=0; ii< currentFiles.size(); ii++)
-				{
-					_tmpCountIterators.push_back( new IteratorFile<abundance_t> (currentFiles[ii])  );
-				}
-				std::priority_queue< ptcf, std::vector<ptcf>,ptcfcomp > pq;
-				
-				
-				//// init all iterators  ////
-				for(size_t ii=0; ii< _tmpCountIterators.size(); ii++)
+				//now merge the n sorted files and merge their kmer counts.
 				{
-					_tmpCountIterators[ii]->first();
-				}
-				
-				//////   init pq ////
-				for(size_t ii=0; ii< _tmpCountIterators.size(); ii++)
-				{
-					if( ! _tmpCountIterators[ii]->isDone())  {
-						pq.push(ptcf(ii,_tmpCountIterators[ii]->item().value) );
-					}
-				}
-				
-				//now merge the n sorted iterators and merge their kmer counts.
-				if(pq.size() != 0)
-				{
-					//get first pointer
-					best_elem = pq.top() ; pq.pop();
-					best_p = best_elem.first;
-					previous_ab = _tmpCountIterators[best_p]->item().abundance;
-					previous_kmer = best_elem.second;
-					
-					//go forward in this list
-					_tmpCountIterators[best_p]->next();
-					if (! _tmpCountIterators[best_p]->isDone())
+					CountMerger<abundance_t> merger;
+					for(size_t ii=0; ii< currentFiles.size(); ii++)
 					{
-						pq.push(ptcf( best_p,_tmpCountIterators[best_p]->item().value) );
+						merger.addFile (currentFiles[ii]);
 					}
-					
-					while (pq.size() != 0)
-					{
-						
-						//get  first pointer
-						best_elem = pq.top() ; pq.pop();
-						best_p = best_elem.first;
-						current_ab = _tmpCountIterators[best_p]->item().abundance;
-						current_kmer = best_elem.second;
-						
-						//go forward in this list
-						_tmpCountIterators[best_p]->next();
-						if (! _tmpCountIterators[best_p]->isDone())
-						{
-							pq.push(ptcf( best_p,_tmpCountIterators[best_p]->item().value) );
-						}
-						
-						
-						if(current_kmer != previous_kmer)
-						{
-							//output previous kmer
-							currentbag->insert( abundance_t(previous_kmer,previous_ab) );
-							previous_kmer = current_kmer;
-							previous_ab = current_ab;
-						}
-						else
-						{
-							//merge counter
-							previous_ab += current_ab;
-						}
-					}
-					
-					//output last one
-					currentbag->insert( abundance_t(previous_kmer,previous_ab) );
+					merger.merge ([&] (const Type& kmer, u_int64_t abundance)  {  currentbag->insert (abundance_t (kmer, abundance));  });
 				}
 				
 
 				currentbag->flush();
 
 				
-				//cleanup
-				
-				for(size_t ii=0; ii< _tmpCountIterators.size(); ii++)
-				{
-					delete _tmpCountIterators[ii];
-				}
-				
-				
 				//erase used files
 				for(size_t ii=0; ii< currentFiles.size(); ii++)
 				{
@@ -358,6 +278,157 @@ PartitionsByHashCommand<span>:: PartitionsByHashCommand (
 		int _idx;
 		
 	};
+
+	//source of a CountMerger reading the sorted cells of the hash table of a partition
+	template<typename Type, typename abundance_t>
+	class HashCountSource : public CountMerger<abundance_t>::Source
+	{
+		typedef typename tools::collections::impl::Hash16<Type>::cell cell_t;
+		
+	public:
+		HashCountSource(Iterator<cell_t>* it) : _it(it)  {  _it->first();  }
+		
+		size_t read (std::vector<abundance_t>& block)
+		{
+			size_t n = 0;
+			for( ; n<block.size() && !_it->isDone(); n++, _it->next())
+			{
+				cell_t & cell = _it->item();
+				block[n].value     = cell.graine;
+				block[n].abundance = cell.val;
+			}
+			return n;
+		}
+		
+		private :
+		
+		Iterator<cell_t>* _it;
+	};
+
+	//dump the content of a hash table, sorted, into a new subpart file, then empty the hash table
+	template<typename Type>
+	void dumpSortedCounts (Hash16<Type>& hash, const std::string& prefix, std::vector<string>& filenames)
+	{
+		typedef typename Hash16<Type>::cell cell_t;
+		typedef tools::misc::Abundance<Type> abundance_t;
+		
+		Iterator < cell_t >* itKmerAbundancePartial = hash.iterator(true);
+		LOCAL (itKmerAbundancePartial);
+		
+		std::string fname = prefix + Stringify::format ("_subpart_%i", filenames.size()) ;
+		filenames.push_back(fname);
+		
+		BagFile<abundance_t> * bagf = new BagFile<abundance_t>(fname); LOCAL(bagf);
+		Bag<abundance_t> * currentbag =  new BagCache<abundance_t> (  bagf, 10000 ); LOCAL(currentbag);
+		
+		for (itKmerAbundancePartial->first(); !itKmerAbundancePartial->isDone(); itKmerAbundancePartial->next())
+		{
+			cell_t & cell = itKmerAbundancePartial->item();
+			currentbag->insert( abundance_t(cell.graine,cell.val) );
+		}
+		
+		currentbag->flush();
+		hash.clear();
+	}
+	
+	//output the counts of a hash table merged with the subpart files dumped from it, sorted by kmer values;
+	//the subpart files are removed
+	template<size_t span, typename Functor>
+	void outputSortedCounts (Hash16<typename Kmer<span>::Type>& hash, std::vector<string> filenames, Functor output)
+	{
+		typedef typename Kmer<span>::Type  Type;
+		typedef typename Hash16<Type>::cell cell_t;
+		typedef tools::misc::Abundance<Type> abundance_t;
+		
+		Iterator < cell_t >* itKmerAbundance = hash.iterator(true);
+		LOCAL (itKmerAbundance);
+		
+		if(filenames.size()==0) // in that case no merging needed, just iterate the hash table and output kmer counts
+		{
+			for (itKmerAbundance->first(); !itKmerAbundance->isDone(); itKmerAbundance->next())
+			{
+				cell_t & cell = itKmerAbundance->item();
+				output (cell.graine, cell.val);
+			}
+			return;
+		}
+		
+		TempCountFileMerger<span> tempCountFileMerger (10,10);
+		//will merge by chunk of 10 files at a time, until reach less than 10 files
+		filenames = tempCountFileMerger.mergeFiles(filenames);
+		
+		//merge the contents of the hash table with the remaining files; the hash table cells hold int abundances,
+		//so the merge is done with 32 bits abundances
+		typedef tools::misc::Abundance<Type,u_int32_t> merged_t;
+		{
+			CountMerger<merged_t> merger;
+			merger.addSource (new HashCountSource<Type,merged_t> (itKmerAbundance));
+			for(size_t ii=0; ii< filenames.size(); ii++)
+			{
+				merger.template addFile<abundance_t> (filenames[ii]);
+			}
+			merger.merge (output);
+		}
+		
+		//erase sub files
+		for(size_t ii=0; ii< filenames.size(); ii++)
+		{
+			system::impl::System::file().remove(filenames[ii]);
+		}
+	}
+	
+	//spill of the counts of a partition into bucket files, according to the high bits of the kmers values:
+	//the buckets hold disjoint ranges of kmers in increasing order, so they can be counted independently
+	//and output one after the other.
+	template<size_t span>
+	class RadixSpill
+	{
+		typedef typename Kmer<span>::Type  Type;
+		typedef typename Hash16<Type>::cell cell_t;
+		
+	public:
+		typedef tools::misc::Abundance<Type,u_int32_t> spilled_t;
+		
+		RadixSpill(const std::string& prefix, size_t nbBits, size_t kmerSize) : _shift(2*kmerSize - nbBits)
+		{
+			for(size_t ii=0; ii< ((size_t)1 << nbBits); ii++)
+			{
+				_filenames.push_back (prefix + Stringify::format ("_bucket_%i", ii));
+				_bags.push_back (new BagCache<spilled_t> (new BagFile<spilled_t>(_filenames.back()), 1024));
+				_bags.back()->use();
+			}
+		}
+		
+		~RadixSpill()
+		{
+			for(size_t ii=0; ii< _bags.size(); ii++)  {  _bags[ii]->forget();  }
+		}
+		
+		//write the cells of the hash table (not sorted) into their buckets
+		void spill (Hash16<Type>& hash)
+		{
+			Iterator < cell_t >* it = hash.iterator(false);
+			LOCAL (it);
+			
+			for (it->first(); !it->isDone(); it->next())
+			{
+				cell_t & cell = it->item();
+				_bags[(cell.graine >> _shift).getVal()]->insert (spilled_t (cell.graine, cell.val));
+			}
+		}
+		
+		void flush ()  {  for(size_t ii=0; ii< _bags.size(); ii++)  {  _bags[ii]->flush();  }  }
+		
+		size_t size ()  {  return _filenames.size();  }
+		
+		const std::string& getFileName (size_t idx)  {  return _filenames[idx];  }
+		
+		private :
+		
+		size_t _shift;
+		std::vector<string> _filenames;
+		std::vector<Bag<spilled_t>*> _bags;
+	};
 	
 	
 /*********************************************************************
@@ -371,8 +442,6 @@ PartitionsByHashCommand<span>:: PartitionsByHashCommand (
 template<size_t span>
 void PartitionsByHashCommand<span>:: execute ()
 {
-	typedef typename tools::collections::impl::Hash16<Type>::cell cell_t;
-
 		this->_superKstorage->openFile("r",this->_parti_num);
 	
 	this->_processor->beginPart (this->_pass_num, this->_parti_num, this->_cacheSize, this->getName());
@@ -395,8 +464,9 @@ void PartitionsByHashCommand<span>:: execute ()
 ));
 	
 	
-	typedef tools::misc::Abundance<Type> abundance_t;
-	std::vector<string> _tmpCountFileNames;
+	//kmers of the partition spilled to disk when the hash table is full (see RadixSpill)
+	RadixSpill<span>* spill = 0;
+	u_int64_t nbKmersInserted = 0;
 	
 
 		//with decompactage
@@ -427,6 +497,7 @@ void PartitionsByHashCommand<span>:: execute ()
 			{
 				//decode a superkmer
 				nbK = *ptr; ptr++;
+				nbKmersInserted += nbK;
 				//int nb_bytes_superk = (this->_kmerSize + nbK -1 +3) /4  ;
 				
 				int rem_size = this->_kmerSize;
@@ -500,33 +571,27 @@ void PartitionsByHashCommand<span>:: execute ()
 				//now go to next superk of this block, ptr should point to beginning of next superk
 			}
 			
-			//check if hashtable is getting too big : in that case dump it disk and resume with the emptied hashtable
-			//at the end merge-sort all the dumped files with the content of hash table
+			//check if hashtable is getting too big : in that case spill it to disk and resume with the emptied hashtable.
+			//the spilled kmers go into buckets according to their high bits, that are counted one after the other at the end
 			if(hash16.getByteSize() > _hashMemory) // to be improved (can be slightly larger than maxmemory by a block size)
-				//if(_tmpCountFileNames.size()<20) //force  dumps for testing
 			{
-				//printf("splitting into subparts %lli KB / %lli KB  parti %i subpart %i \n",hash16.getByteSize()/1024,_hashMemory/1024 ,this->_parti_num,_tmpCountFiles.size()  );
-				//dump partial count to disk file
-				
-				
-				Iterator < cell_t >* itKmerAbundancePartial = hash16.iterator(true);
-				LOCAL (itKmerAbundancePartial);
-				
-				
-				std::string fname = this->_superKstorage->getFileName(this->_parti_num) + Stringify::format ("_subpart_%i", _tmpCountFileNames.size()) ;
-				_tmpCountFileNames.push_back(fname);
-				
-				BagFile<abundance_t> * bagf = new BagFile<abundance_t>(fname); LOCAL(bagf);
-				Bag<abundance_t> * currentbag =  new BagCache<abundance_t> (  bagf, 10000 ); LOCAL(currentbag);
-				
-				
-				for (itKmerAbundancePartial->first(); !itKmerAbundancePartial->isDone(); itKmerAbundancePartial->next())
+				if(spill == 0)
 				{
-					cell_t & cell = itKmerAbundancePartial->item();
-					currentbag->insert( abundance_t(cell.graine,cell.val) );
+					//extrapolate the size of the hash table for the whole partition (an upper bound, since the number of distinct
+					//kmers grows more slowly than the number of kmers); each bucket should fit in the memory of one thread,
+					//with a factor 2 since canonical kmers favour low values.
+					double expectedSize = (double) hash16.getByteSize() * this->_pInfo.getNbKmer(this->_parti_num) / std::max (nbKmersInserted, (u_int64_t)1);
+					double bucketMemory = 0.9 * _hashMemory / std::max (this->_nbCores, (size_t)1);
+					
+					size_t nbBits = 1;
+					while (nbBits < 8 && 2*expectedSize / ((size_t)1 << nbBits) > bucketMemory)  { nbBits++; }
+					
+					DEBUG (("PartitionsByHashCommand::execute:  parti num %i  spills into %i buckets\n", this->_parti_num, 1 << nbBits));
+					
+					spill = new RadixSpill<span> (this->_superKstorage->getFileName(this->_parti_num), nbBits, this->_kmerSize);
 				}
 				
-				currentbag->flush();			
+				spill->spill (hash16);
 				hash16.clear();
 			}
 		}
@@ -539,197 +604,62 @@ void PartitionsByHashCommand<span>:: execute ()
 
 	/** We loop over the solid kmers map.
 	 * NOTE !!! we want the items to be sorted by kmer values (see finalize part of debloom). */
-	//Iterator < Abundance<Type> >* itKmerAbundance = hash.iterator(true);
-	//shortcut
-	Iterator < cell_t >* itKmerAbundance = hash16.iterator(true);
-	LOCAL (itKmerAbundance);
-	
-	
-	//now merge sort over current hash and over the sorted _tmpCountFiles
-	// : simple merge sort of n sorted iterators
-	
-	if(_tmpCountFileNames.size()!=0)
+	auto output = [&] (const Type& kmer, u_int64_t abundance)
 	{
-		
-		TempCountFileMerger<span> tempCountFileMerger (10,10);
-		//will merge by chunk of 10 files at a time, until reach less than 10 files
-		_tmpCountFileNames = tempCountFileMerger.mergeFiles(_tmpCountFileNames);
-		//then will use code below to merge remaining files with the contents of the hash table
-
-		std::vector<Iterator<abundance_t>*> _tmpCountIterators;
-
-		//how to make sure there are not too many subpart files ?  and that we'll not reach the max open files limit ?
-		//we *could* merge  only some of them at a time ..  todo ?  --> done with TempCountFileMerger above
-		for(size_t ii=0; ii< _tmpCountFileNames.size(); ii++)
-		{
-			std::string fname = _tmpCountFileNames[ii];
-			_tmpCountIterators.push_back( new IteratorFile<abundance_t> (fname)  );
-		}
+		solidCounter.set (abundance);
+		this->insert (kmer, solidCounter);
+	};
 	
-		// Note (guillaume) : code below is ugly because I have to manage itKmerAbundance (iterator over cell_t)
-		// and _tmpCountIterators (iterators over abundance_t) differently since they have different types
-		// I would have liked to transform  Iterator<cell_t>  to an Iterator<abundance_t>   with the following adaptor :
-		//
-		// 		struct cell2AbAdaptor  {  abundance_t operator() (cell_t& c)  { return abundance_t(c.graine,c.val) ; }  };
-		//Iterator<abundance_t>*   hashAbundance  = new IteratorAdaptor<cell_t,abundance_t,cell2AbAdaptor> (itKmerAbundance);
-	    //	but it turns out to be impossible because of the return by reference of the   item()  function.
-		//  Another solution would be to dump contents of hash to a file then read it, but inefficient
-		//  So, ugly code it is.  (see all the if(best_p==-1) below)
-		
-		
-		//setup the priority queue for merge sorting
-		typedef std::pair< int , Type> ptcf; //  id pointer , kmer value
-		struct ptcfcomp { bool operator() (ptcf l,ptcf r) { return ((r.second) < (l.second)); } } ;
-		std::priority_queue< ptcf, std::vector<ptcf>,ptcfcomp > pq;
-
-		//// init all iterators  ////
-		itKmerAbundance->first();
-		for(size_t ii=0; ii< _tmpCountIterators.size(); ii++)
-		{
-			_tmpCountIterators[ii]->first();
-		}
-		
-		//////   init pq ////
-
-		if(!itKmerAbundance->isDone())
-		{
-			pq.push(ptcf(-1,itKmerAbundance->item().graine) ); // -1  will mean in the  itKmerAbundance
-		}
-		
-		for(size_t ii=0; ii< _tmpCountIterators.size(); ii++)
-		{
-			if( ! _tmpCountIterators[ii]->isDone())  {
-				abundance_t &ab = _tmpCountIterators[ii]->item();
-				pq.push(ptcf(ii,ab.value) );
-			}
-		}
+	if(spill == 0)
+	{
+		outputSortedCounts<span> (hash16, std::vector<string>(), output);
+	}
+	else
+	{
+		spill->spill (hash16);
+		hash16.clear();
+		spill->flush();
 		
-		ptcf best_elem;
-		int best_p;
-		int current_ab = 0;
-		int previous_ab = 0;
-		Type current_kmer,previous_kmer;
+		//count the buckets by batches of one bucket per thread, each with its own hash table. the counts of the buckets
+		//of a batch are then output in order. a bucket that does not fit in memory is dumped in sorted subpart files,
+		//merged when the bucket is output
+		size_t    nbThreads    = std::min (std::max (this->_nbCores, (size_t)1), spill->size());
+		u_int64_t bucketMemory = 0.9 * _hashMemory / nbThreads; // the table of hash16 is kept (a tenth of the memory)
 		
-	
-	    //now merge the n sorted iterators and merge their kmer counts.
-		if(pq.size() != 0)
+		for(size_t b0=0; b0< spill->size(); b0+=nbThreads)
 		{
-			//get first pointer
-			best_elem = pq.top() ; pq.pop();
-			best_p = best_elem.first;
-			if(best_p==-1)
-			{
-				previous_ab = itKmerAbundance->item().val;
-			}
-			else
-			{
-				previous_ab = _tmpCountIterators[best_p]->item().abundance;
-			}
+			size_t n = std::min (nbThreads, spill->size() - b0);
 			
-			previous_kmer = best_elem.second;
-
-			//go forward in this list
-
-			if(best_p==-1)
-			{
-				itKmerAbundance->next();
-				if (! itKmerAbundance->isDone())
-				{
-					pq.push(ptcf(-1,itKmerAbundance->item().graine) );
-				}
-			}
-			else
-			{
-				_tmpCountIterators[best_p]->next();
-				if (! _tmpCountIterators[best_p]->isDone())
-				{
-					pq.push(ptcf( best_p,_tmpCountIterators[best_p]->item().value) );
-				}
-			}
+			std::vector<Hash16<Type>*>      hashes (n, 0);
+			std::vector<std::vector<string> > subparts (n);
 			
-			while (pq.size() != 0)
+			Range<size_t>::Iterator it (0, n-1);
+			Dispatcher(n).iterate (it, [&] (size_t i)
 			{
+				std::string fname = spill->getFileName(b0+i);
 				
-				//get  first pointer
-				best_elem = pq.top() ; pq.pop();
-				best_p = best_elem.first;
-				
-				if(best_p==-1)
-				{
-					current_ab = itKmerAbundance->item().val;
-				}
-				else
-				{
-					current_ab = _tmpCountIterators[best_p]->item().abundance;
-				}
-				current_kmer = best_elem.second;
+				hashes[i] = new Hash16<Type> (std::max (bucketMemory/MBYTE, (u_int64_t)1));
 				
-				//go forward in this list
-				if(best_p==-1)
-				{
-					itKmerAbundance->next();
-					if (! itKmerAbundance->isDone())
-					{
-						pq.push(ptcf(-1,itKmerAbundance->item().graine) );
-					}
-				}
-				else
-				{
-					_tmpCountIterators[best_p]->next();
-					if (! _tmpCountIterators[best_p]->isDone())
-					{
-						pq.push(ptcf( best_p,_tmpCountIterators[best_p]->item().value) );
-					}
-				}
-
-				if(current_kmer != previous_kmer)
-				{
-					//output previous kmer
-					solidCounter.set (previous_ab);
-					this->insert (previous_kmer, solidCounter);
-					previous_kmer = current_kmer;
-					previous_ab = current_ab;
-				}
-				else
+				IteratorFile<typename RadixSpill<span>::spilled_t> itSpilled (fname);
+				for (itSpilled.first(); !itSpilled.isDone(); itSpilled.next())
 				{
-					//merge counter
-					previous_ab += current_ab;
+					hashes[i]->add (itSpilled->value, itSpilled->abundance);
+					
+					if(hashes[i]->getByteSize() > bucketMemory)  {  dumpSortedCounts (*hashes[i], fname, subparts[i]);  }
 				}
-				
+			}, 1);
+			
+			for(size_t i=0; i< n; i++)
+			{
+				outputSortedCounts<span> (*hashes[i], subparts[i], output);
+				delete hashes[i];
+				system::impl::System::file().remove (spill->getFileName(b0+i));
 			}
-
-			//output last one
-			solidCounter.set (previous_ab);
-			this->insert (previous_kmer, solidCounter);
-		}
-		
-
-		//cleanup
-		for(long unsigned int ii=0; ii< _tmpCountIterators.size(); ii++)
-		{
-			delete _tmpCountIterators[ii];
-		}
-		
-		
-		//erase sub files
-		for(long unsigned int ii=0; ii< _tmpCountFileNames.size(); ii++)
-		{
-			std::string fname = _tmpCountFileNames[ii];
-			system::impl::System::file().remove(fname);
 		}
 		
+		delete spill;
 	}
-	else // in that case no merging needed, just iterate the hash table and output kmer counts
-	{
-		for (itKmerAbundance->first(); !itKmerAbundance->isDone(); itKmerAbundance->next())
-		{
-			
-			cell_t & cell = itKmerAbundance->item();
-			solidCounter.set (cell.val);
-			this->insert (cell.graine, solidCounter);
-		}
-	}
-
+	
 	
 	this->_superKstorage->closeFile(this->_parti_num);
 	
@@ -1238,6 +1168,67 @@ void PartitionsByVectorCommand<span>::execute ()
     this->_processor->endPart (this->_pass_num, this->_parti_num);
 };
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+/** Touch the radix buckets [begin,end] (for each of the nbSets sets of buckets) from the node of the
+ * thread that will sort them, so that the pool pages get placed on that node before the kmers are read.
+ * The Dispatcher runs the command i of N on the NUMA node i*nbNodes/N, so the TouchCommand and the
+ * SortCommand of a same range run on the same node. */
+template<size_t span>
+class TouchCommand : public gatb::core::tools::dp::ICommand, public system::SmartPointer
+{
+public:
+    typedef typename Kmer<span>::Type  Type;
+
+    /** Constructor. */
+    TouchCommand (MemAllocator& pool, Type** kmervec, uint64_t* radix_sizes, size_t nbSets, int begin, int end)
+        : _pool(pool), _radix_kmers(kmervec), _radix_sizes(radix_sizes), _nbSets(nbSets), _deb(begin), _fin(end) {}
+
+    /** */
+    void execute ()
+    {
+        for (size_t xx=0; xx<_nbSets; xx++)
+        {
+            for (int ii=_deb; ii<=_fin; ii++)  {  _pool.touch (_radix_kmers[IX(xx,ii)], _radix_sizes[IX(xx,ii)] * sizeof(Type));  }
+        }
+    }
+
+private :
+    MemAllocator& _pool;
+    Type**        _radix_kmers;
+    uint64_t*     _radix_sizes;
+    size_t        _nbSets;
+    int           _deb;
+    int           _fin;
+};
+
+/** Dispatch the TouchCommand of each sort thread (same split of the radix buckets as executeSort). */
+template<size_t span>
+static void touchRadixBuckets (IDispatcher* dispatcher, MemAllocator& pool, typename Kmer<span>::Type** radix_kmers, uint64_t* radix_sizes, size_t nbSets, size_t nbCores)
+{
+    if (pool.getNbNumaNodes() <= 1)  { return; }
+
+    int nwork = 256 / nbCores;
+
+    vector<ICommand*> cmds;
+    for (size_t tid=0; tid < nbCores; tid++)
+    {
+        int deb = 0 + tid * nwork;
+        int fin = (tid+1) * nwork -1;
+        if(tid == nbCores-1)  { fin = 255; }
+
+        cmds.push_back (new TouchCommand<span> (pool, radix_kmers, radix_sizes, nbSets, deb, fin));
+    }
+
+    dispatcher->dispatchCommands (cmds, 0);
+}
+
 
 	
 	
@@ -1314,6 +1305,9 @@ void PartitionsByVectorCommand<span>::executeRead ()
 		}
     }
 
+    /** On NUMA machines, the buckets pages are placed now by the threads that will sort them. */
+    touchRadixBuckets<span> (_dispatcher, this->_pool, _radix_kmers, _radix_sizes, KX+1, this->_nbCores);
+
     DEBUG (("PartitionsByVectorCommand<span>::executeRead:  fillsolid parti num %i  by vector  nb kxmer / nbkmers      %lli / %lli     %f   with %zu nbcores \n",
         this->_parti_num, sum_nbxmer, this->_pInfo.getNbKmer(this->_parti_num),
         (double) sum_nbxmer /  this->_pInfo.getNbKmer(this->_parti_num),this->_nbCores
@@ -1948,6 +1942,9 @@ void PartitionsByVectorCommand_multibank<span>::executeRead ()
 		}
 	}
 	
+	/** On NUMA machines, the buckets pages are placed now by the threads that will sort them. */
+	touchRadixBuckets<span> (_dispatcher, this->_pool, _radix_kmers, _radix_sizes, KX+1, this->_nbCores);
+
 	DEBUG (("PartitionsByVectorCommand<span>::executeRead:  fillsolid parti num %i  by vector  nb kxmer / nbkmers      %lli / %lli     %f   with %zu nbcores \n",
 			this->_parti_num, sum_nbxmer, this->_pInfo.getNbKmer(this->_parti_num),
 			(double) sum_nbxmer /  this->_pInfo.getNbKmer(this->_parti_num),this->_nbCores
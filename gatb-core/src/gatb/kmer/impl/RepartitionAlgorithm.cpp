@@ -35,6 +35,7 @@
 #include <gatb/tools/collections/impl/BagFile.hpp>
 #include <gatb/tools/collections/impl/BagCache.hpp>
 #include <gatb/tools/collections/impl/IteratorFile.hpp>
+#include <gatb/tools/collections/impl/HyperLogLog.hpp>
 
 #include <gatb/tools/misc/impl/Progress.hpp>
 #include <gatb/tools/misc/impl/Property.hpp>
@@ -44,6 +45,7 @@
 #include <iostream>
 #include <map>
 #include <math.h>
+#include <string.h>
 
 #include <gatb/tools/math/Integer.hpp>
 #include <gatb/tools/math/NativeInt8.hpp>
@@ -88,6 +90,14 @@ static const char* progressFormat0 = "DSK: Collecting stats on %s ";
 
 /********************************************************************************/
 
+/* This functor class counts the mmers of the sequences, for computing the frequency order of
+ * the minimizers. Each thread counts in its own table, which is added to the global one when
+ * the functor is destroyed.
+ *
+ * The counting stops when the frequencies are stable: each time the number of sequences seen by
+ * a thread doubles, the distribution of its counts is compared with the one of the previous check
+ * (Kullback-Leibler divergence); the whole iteration is cancelled once it is below a threshold.
+ */
 template<size_t span>
 class MmersFrequency
 {
@@ -110,44 +120,152 @@ public:
                 continue;
 
             /** increment m-mer count */
-            _m_mer_counts[_mmers[i].value().getVal()] ++;
+            _counts[_mmers[i].value().getVal()] ++;
+            _nbMmers ++;
         }
 
-        if (_nbProcessedMmers > 500000)   {  _progress.inc (_nbProcessedMmers);  _nbProcessedMmers = 0;  }
-
-        // see if we need to stop. 
+        // see if we need to stop.
         // mimics SampleRepart below. but actually, as TruncatedIterator would have worked too, since all seqs are at least larger than a mmer. oh well. using CancellableIterator anyway.
         _nbSeqsSeenSoFar ++;
         if (_nbSeqsSeenSoFar > _nbSeqsToSee)
         {
             *_cancelIterator = true;
         }
-
+        else if (_nbSeqsSeenSoFar == _nextCheck)
+        {
+            if (hasConverged())  {  *_cancelIterator = true;  }
+            _nextCheck *= 2;
+        }
     }
 
     /** Constructor. */
-    MmersFrequency (int mmerSize,  IteratorListener* progress,  uint32_t* m_mer_counts, size_t nbSeqsToSee /* for when to stop estimation*/, bool* cancelIterator)
+    MmersFrequency (
+        int               mmerSize,
+        uint32_t*         m_mer_counts,
+        size_t            nbSeqsToSee, /* for when to stop estimation, per thread */
+        size_t            firstCheck,
+        double            threshold,
+        bool*             cancelIterator,
+        u_int64_t&        nbSeqsTotal
+    )
     :
-        _minimodel(mmerSize), _progress (progress,System::thread().newSynchronizer()),
-      _m_mer_counts(m_mer_counts),  _nbProcessedMmers(0), _nbSeqsToSee(nbSeqsToSee), _nbSeqsSeenSoFar(0), _cancelIterator(cancelIterator)
+        _minimodel(mmerSize), _globalCounts(m_mer_counts), _counts ((u_int64_t)1 << (2*mmerSize), 0), _nbMmers(0),
+        _snapshotNbMmers(0), _nbSeqsToSee(nbSeqsToSee), _nbSeqsSeenSoFar(0), _nextCheck(firstCheck), _threshold(threshold),
+        _cancelIterator(cancelIterator), _nbSeqsTotal(nbSeqsTotal)
     {
-        u_int64_t nbminim = (uint64_t)pow(4.0,mmerSize);
+    }
 
-        for (u_int64_t i = 0; i < nbminim; i++)  {   _m_mer_counts[i] = 0;  }
+    /** Destructor; the dispatcher calls the destructors of the functors one at a time. */
+    ~MmersFrequency ()
+    {
+        for (size_t i=0; i<_counts.size(); i++)  {  _globalCounts[i] += _counts[i];  }
+        _nbSeqsTotal += _nbSeqsSeenSoFar;
     }
 
-protected:
+private:
+
+    /** Compare the current distribution of the counts with the one of the previous check,
+     * and keep the current one for the next check. */
+    bool hasConverged ()
+    {
+        bool result = false;
+
+        if (_snapshotNbMmers > 0)
+        {
+            /** KL divergence of the current distribution from the previous one; the previous one
+             * is smoothed, since mmers may be seen only now. */
+            double smoothing = 0.5;
+            double total     = _snapshotNbMmers + smoothing * _counts.size();
+            double kl        = 0;
+
+            for (size_t i=0; i<_counts.size(); i++)
+            {
+                if (_counts[i] == 0)  { continue; }
+                double q = (double)_counts[i] / _nbMmers;
+                double p = (_snapshot[i] + smoothing) / total;
+                kl += q * log (q / p);
+            }
+
+            DEBUG (("MmersFrequency: %ld sequences, KL divergence %g\n", _nbSeqsSeenSoFar, kl));
+
+            result = kl < _threshold;
+        }
+
+        _snapshot        = _counts;
+        _snapshotNbMmers = _nbMmers;
+
+        return result;
+    }
 
     ModelCanonical           _minimodel;
     //ModelDirect                _minimodel;
     vector<KmerTypeCanonical>  _mmers;
     //vector<KmerTypeDirect>  _mmers;
-    ProgressSynchro         _progress;
-    uint32_t*               _m_mer_counts;
-    size_t                  _nbProcessedMmers;
+    uint32_t*               _globalCounts;
+    vector<uint32_t>        _counts;
+    u_int64_t               _nbMmers;
+    vector<uint32_t>        _snapshot;
+    u_int64_t               _snapshotNbMmers;
     size_t        _nbSeqsToSee;
     size_t        _nbSeqsSeenSoFar;
+    size_t        _nextCheck;
+    double        _threshold;
     bool *            _cancelIterator;
+    u_int64_t&    _nbSeqsTotal;
+};
+
+/********************************************************************************/
+/* Sketches of the kmers seen while sampling the bank, for estimating the number of distinct
+ * kmers of the whole bank without reading it.
+ *
+ * The kmers of every other superkmer also go to a second sketch, which gives the number of
+ * distinct kmers of a sample half as large. The growth of the number of distinct kmers between
+ * both samples is then extrapolated to the total number of kmers. Since this number grows more
+ * and more slowly with the sample size, the extrapolation tends to overestimate it.
+ */
+class DistinctKmersSketch
+{
+public:
+
+    /** */
+    DistinctKmersSketch () : _nbKmers(0), _nbKmersHalf(0)  {}
+
+    /** */
+    void insert (u_int64_t hash, bool half)
+    {
+        _all.insert (hash);  _nbKmers++;
+        if (half)  {  _half.insert (hash);  _nbKmersHalf++;  }
+    }
+
+    /** */
+    void merge (const DistinctKmersSketch& other)
+    {
+        _all.merge  (other._all);   _nbKmers     += other._nbKmers;
+        _half.merge (other._half);  _nbKmersHalf += other._nbKmersHalf;
+    }
+
+    /** */
+    u_int64_t getNbKmers   () const  { return _nbKmers; }
+    u_int64_t getNbDistinct() const  { return _all.cardinality(); }
+
+    /** Estimation of the number of distinct kmers among nbKmersTotal kmers. */
+    u_int64_t estimate (u_int64_t nbKmersTotal) const
+    {
+        double distinct = _all.cardinality();
+
+        if (nbKmersTotal <= _nbKmers || _nbKmers <= _nbKmersHalf)  {  return distinct;  }
+
+        double growth = (distinct - _half.cardinality()) / (_nbKmers - _nbKmersHalf);
+
+        return std::min ((double)nbKmersTotal, distinct + std::max (growth, 0.0) * (nbKmersTotal - _nbKmers));
+    }
+
+private:
+
+    HyperLogLog _all;
+    HyperLogLog _half;
+    u_int64_t   _nbKmers;
+    u_int64_t   _nbKmersHalf;
 };
 
 /********************************************************************************/
@@ -182,6 +300,10 @@ public:
             /** We increase superkmer counter the current minimizer. */
             _pInfo.incSuperKmer_per_minimBin (superKmer.minimizer, superKmerLen);
 
+            /** We add the kmers to the distinct kmers sketch; one superkmer out of two goes to the half sample. */
+            bool half = (_nbSuperKmersSeenSoFar & 1) == 0;
+            for (size_t ii=0 ; ii < superKmerLen; ii++)  {  _sketchLocal.insert (wyhash (superKmer[ii].value()), half);  }
+
             /** We loop over the kmer of the superkmer (except the first one).
              *  We update the pInfo each time we find a kxmer in the superkmer. */
             for (size_t ii=1 ; ii < superKmerLen; ii++)
@@ -224,14 +346,24 @@ public:
         bool *            cancelIterator,
         size_t            nbSeqsToSee,
         BankStats&        bankStats,
-        PartiInfo<5>&     pInfo
+        PartiInfo<5>&     pInfo,
+        DistinctKmersSketch& sketch,
+        ISynchronizer*    synchro
     )
     :   Sequence2SuperKmer<span> (model, 1, 0, nbPartitions, progress, bankStats)
         ,_kx(4), _pInfo(pInfo),
-        _cancelIterator(cancelIterator), _nbSeqsToSee(nbSeqsToSee), _nbSuperKmersSeenSoFar(0)
+        _cancelIterator(cancelIterator), _nbSeqsToSee(nbSeqsToSee), _nbSuperKmersSeenSoFar(0),
+        _sketchGlobal(sketch), _synchro(synchro)
     {
     }
 
+    /** Destructor. Each thread has its own sketch, merged into the global one at the end. */
+    ~SampleRepart ()
+    {
+        LocalSynchronizer ls (_synchro);
+        _sketchGlobal.merge (_sketchLocal);
+    }
+
 
 private:
     size_t        _kx;
@@ -240,6 +372,10 @@ private:
     bool*         _cancelIterator;
     size_t        _nbSeqsToSee;
     size_t        _nbSuperKmersSeenSoFar;
+
+    DistinctKmersSketch& _sketchGlobal;
+    DistinctKmersSketch  _sketchLocal;
+    ISynchronizer*       _synchro;
 };
 
 /*********************************************************************
@@ -258,7 +394,8 @@ RepartitorAlgorithm<span>::RepartitorAlgorithm (
     unsigned int nb_cores,
     tools::misc::IProperties*   options
 )
-    :  Algorithm("repartition", nb_cores, options), _config(config), _bank(bank), _group(group), _freq_order(0)
+    :  Algorithm("repartition", nb_cores, options), _config(config), _bank(bank), _group(group), _freq_order(0),
+       _estimatedDistinctKmersNb(0)
 {
 }
 
@@ -291,10 +428,11 @@ void RepartitorAlgorithm<span>::execute ()
      * IMPORTANT ! we have to give the passes number because it has impact on the computation. */
     Repartitor repartitor (_config._nb_partitions, _config._minim_size, _config._nb_passes);
 
-    /* now is a good time to switch to frequency-based minimizers if required:
+    /* now is a good time to switch to frequency-based (or other) minimizers if required:
       because right after we'll start using minimizers to compute the distribution
       of superkmers in bins */
-    if (_config._minimizerType == 1)  {  computeFrequencies (repartitor);  }
+    if (_config._minimizerType == MinimizerOrder::FREQUENCY)               {  computeFrequencies (repartitor);  }
+    else if (MinimizerOrder::isPrecomputed (_config._minimizerType))  {  computeOrder       (repartitor);  }
 
     computeRepartition (repartitor);
 }
@@ -319,7 +457,6 @@ void RepartitorAlgorithm<span>::computeFrequencies (Repartitor& repartitor)
     _bank->estimate (estimateSeqNb, estimateSeqTotalSize, estimateSeqMaxSize);
 
     u_int64_t nbseq_sample = std::min ( u_int64_t (estimateSeqNb * 0.05) ,u_int64_t( 50000000ULL) ) ;
-    // TODO would be better to just stop estimating minimizer frequency when it becomes stable. not after a fixed number of reads
 
     if (nbseq_sample == 0)
         nbseq_sample = 1;
@@ -327,8 +464,12 @@ void RepartitorAlgorithm<span>::computeFrequencies (Repartitor& repartitor)
     u_int64_t rg = ((u_int64_t)1 << (2*_config._minim_size));
     //cout << "\nAllocating " << ((rg*sizeof(uint32_t))/1024) << " KB for " << _minim_size <<"-mers frequency counting (" << rg << " elements total)" << endl;
     uint32_t *m_mer_counts = new uint32_t[rg];
+    memset (m_mer_counts, 0, rg*sizeof(uint32_t));
 
-    Model model (_config._kmerSize, _config._minim_size);
+    /** Each thread needs a table of counts and a snapshot of it; we limit the number of threads
+     * so that they fit in half of the allowed memory. */
+    u_int64_t memPerThread = 2 * rg * sizeof(uint32_t);
+    size_t    nbThreads    = std::max ((u_int64_t)1, std::min ((u_int64_t)getDispatcher()->getExecutionUnitsNumber(), (_config._max_memory*MBYTE/2) / memPerThread));
 
     Iterator<Sequence>* bank_it = _bank->iterator();
     LOCAL(bank_it);
@@ -343,18 +484,30 @@ void RepartitorAlgorithm<span>::computeFrequencies (Repartitor& repartitor)
             );
     LOCAL (it_all_reads);
 
-    /** We compute an estimation of minimizers frequencies from a part of the bank. */
-    
-    SerialDispatcher serialDispatcher;
-    serialDispatcher.iterate (it_all_reads,  MmersFrequency<span> (
-        _config._minim_size, 0 /*_progress*/, m_mer_counts, 
-        nbseq_sample,
-        &(cancellable_it->_cancel))// will be set to true when iteration needs to be stopped
+    /** We compute an estimation of minimizers frequencies from a part of the bank; the sampling
+     * stops earlier if the frequencies are stable. */
+    u_int64_t nbseq_sampled = 0;
+
+    /** The frequencies are considered as stable when the divergence is below 5e-3, ie. when the
+     * counts changed by about 10% (root mean square of the relative changes) since the previous check.
+     * The threads check their own counts, but the global counts are nbThreads times larger, so
+     * their divergence is about nbThreads times lower: the threshold of the threads is scaled
+     * accordingly, and the sample size does not depend on the number of threads. */
+    Dispatcher dispatcher (nbThreads);
+    dispatcher.iterate (it_all_reads,  MmersFrequency<span> (
+        _config._minim_size, m_mer_counts,
+        nbseq_sample / nbThreads + 1,
+        100*1000 / nbThreads + 1,  /* first stability check, then each time the number of sequences doubles */
+        5e-3 * nbThreads,          /* KL divergence threshold */
+        &(cancellable_it->_cancel),// will be set to true when iteration needs to be stopped
+        nbseq_sampled),
+        1000, true /* functors are deleted (and merged) one at a time */
     );
 
-    // single threaded, for debugging
-    /*MmersFrequency<span> mmersfrequency(model, _progress, bstatsDummy, m_mer_counts);
-    it_sample->iterate(mmersfrequency);*/
+    getInfo()->add (1, "minimizers_frequencies");
+    getInfo()->add (2, "nb_threads",            "%ld",  nbThreads);
+    getInfo()->add (2, "nb_sequences_max",      "%lld", nbseq_sample);
+    getInfo()->add (2, "nb_sequences_sampled",  "%lld", nbseq_sampled);
 
     /* sort frequencies */
     for (u_int64_t i(0); i < rg; i++)
@@ -383,6 +536,32 @@ void RepartitorAlgorithm<span>::computeFrequencies (Repartitor& repartitor)
     repartitor.setMinimizerFrequencies (_freq_order);
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the order doesn't depend on the bank, it replaces the frequencies
+**           in the repartitor (and is saved with it for bcalm and debloom).
+*********************************************************************/
+template<size_t span>
+void RepartitorAlgorithm<span>::computeOrder (Repartitor& repartitor)
+{
+    DEBUG (("RepartitorAlgorithm<span>::computeOrder\n"));
+
+    u_int64_t rg = ((u_int64_t)1 << (2*_config._minim_size));
+
+    _freq_order = new uint32_t[rg];
+
+    MinimizerOrder::compute (_config._minimizerType, _config._minim_size, _freq_order);
+
+    getInfo()->add (1, "minimizers_order");
+    getInfo()->add (2, "type",  "%s",  MinimizerOrder::getName (_config._minimizerType));
+
+    repartitor.setMinimizerFrequencies (_freq_order);
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -405,6 +584,11 @@ void RepartitorAlgorithm<span>::computeRepartition (Repartitor& repartitor)
 
     string bankShortName = System::file().getBaseName(_bank->getId());
 
+    /** The number of distinct kmers is estimated from the same sample. */
+    DistinctKmersSketch sketch;
+    ISynchronizer* synchro = System::thread().newSynchronizer();
+    LOCAL (synchro);
+
     // In case of multi bank counting, we get a sample from each bank
     if(_bank->getCompositionNb() > 1){
 
@@ -431,7 +615,9 @@ void RepartitorAlgorithm<span>::computeRepartition (Repartitor& repartitor)
     			&(cancellable_it->_cancel), // will be set to true when iteration needs to be stopped
     			nbseq_sample, // how many sequences we need to see
     			bstatsDummy,
-    			sample_info
+    			sample_info,
+    			sketch,
+    			synchro
     		));
 
     		//cout << "end" << endl;
@@ -470,18 +656,29 @@ void RepartitorAlgorithm<span>::computeRepartition (Repartitor& repartitor)
 			&(cancellable_it->_cancel), // will be set to true when iteration needs to be stopped
 			nbseq_sample, // how many sequences we need to see
 			bstatsDummy,
-			sample_info
+			sample_info,
+			sketch,
+			synchro
 		));
     }
 
-    if (_config._minimizerType == 1)
+    if (_config._minimizerType == MinimizerOrder::FREQUENCY)
     {
         repartitor.justGroup (sample_info, _counts);
     }
     else
     {
         repartitor.computeDistrib (sample_info);
-        if (_config._repartitionType == 1)
+        if (_config._repartitionType == 1 && _freq_order != 0)
+        {
+            /* bcalm needs the partitions in the order of the minimizers: we group all the mmers sorted by rank */
+            u_int64_t rg = ((u_int64_t)1 << (2*_config._minim_size));
+            for (u_int64_t i = 0; i < rg; i++)  {  _counts.push_back (make_pair ((int)_freq_order[i], (int)i));  }
+            sort (_counts.begin(), _counts.end());
+
+            repartitor.justGroup (sample_info, _counts);
+        }
+        else if (_config._repartitionType == 1)
         {
             repartitor.justGroupLexi (sample_info); // For bcalm, i need the minimizers to remain in order. so using this suboptimal but okay repartition
         }
@@ -489,6 +686,14 @@ void RepartitorAlgorithm<span>::computeRepartition (Repartitor& repartitor)
 
     /** We save the distribution (may be useful for debloom for instance). */
     repartitor.save (getGroup());
+
+    /** We extrapolate the number of distinct kmers of the sample to the whole bank. */
+    _estimatedDistinctKmersNb = sketch.estimate (_config._kmersNb);
+
+    getInfo()->add (1, "distinct_kmers");
+    getInfo()->add (2, "sample_kmers_nb",          "%lld", sketch.getNbKmers());
+    getInfo()->add (2, "sample_distinct_kmers_nb", "%lld", sketch.getNbDistinct());
+    getInfo()->add (2, "estimated_distinct_kmers_nb", "%lld", _estimatedDistinctKmersNb);
 }
 
 /********************************************************************************/
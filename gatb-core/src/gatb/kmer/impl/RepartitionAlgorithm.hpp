@@ -33,6 +33,7 @@
 #include <gatb/kmer/impl/Model.hpp>
 #include <gatb/kmer/impl/Configuration.hpp>
 #include <gatb/kmer/impl/PartiInfo.hpp>
+#include <gatb/kmer/impl/MinimizerOrder.hpp>
 #include <gatb/tools/storage/impl/Storage.hpp>
 #include <string>
 
@@ -71,9 +72,15 @@ public:
     /** */
     void execute ();
 
+    /** Get the number of distinct kmers of the bank, estimated from the kmers sampled for
+     * computing the repartition.
+     * \return the estimation, 0 before execute. */
+    u_int64_t getEstimatedDistinctKmersNb () const  { return _estimatedDistinctKmersNb; }
+
 private:
 
     void computeFrequencies (Repartitor& repartitor);
+    void computeOrder       (Repartitor& repartitor);
     void computeRepartition (Repartitor& repartitor);
 
     Configuration _config;
@@ -86,6 +93,8 @@ private:
     tools::storage::impl::Group& getGroup() { return  _group; }
 
     std::vector<std::pair<int, int> > _counts;
+
+    u_int64_t _estimatedDistinctKmersNb;
 };
 
 /********************************************************************************/
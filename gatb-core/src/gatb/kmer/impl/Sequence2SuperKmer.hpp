@@ -77,64 +77,6 @@ public:
     static const u_int64_t DEFAULT_MINIMIZER = 1000000000 ;
 
 
-	template<typename KType>
-	struct KmerFunctor
-	{
-		
-		Sequence2SuperKmer * caller;
-		SuperKmer& superKmer;
-		int maxs;
-		KmerFunctor (Sequence2SuperKmer * Seq2SupCaller,SuperKmer& superKmer,int maxs) :
-		caller(Seq2SupCaller),superKmer(superKmer), maxs(maxs) {}
-		
-		void operator() (const KType& kmer, size_t idx)  {
-			
-			//kmer.toString(_kmerSize)
-		 if (kmer.isValid() == false)
-		 {
-			// printf("non valid kmer %s \n", kmer.value().toString(31).c_str());
-			 //caller->_model.toString(kmer)
-			 // on invalid kmer : output previous superk utput prev
-			 caller->processSuperkmer (superKmer);
-			 superKmer.reset();
-			 
-			 superKmer.minimizer = DEFAULT_MINIMIZER;  //marking will have to restart 'from new'
-			 
-			 caller->_bankStatsLocal.kmersNbInvalid ++;
-			 
-			 return;
-		 }
-			
-			caller->_bankStatsLocal.kmersNbValid ++;
-			
-			/** We get the value of the current minimizer. */
-			u_int64_t h = kmer.minimizer().value().getVal();
-			
-			if(DEFAULT_MINIMIZER == h)
-			{
-				printf("__ non valid kmer %s \n", kmer.value().toString(31).c_str());
-
-			}
-			
-			/** We have to set minimizer value if not defined. */
-			if (superKmer.isValid() == false)  {  superKmer.minimizer = h;  }
-			
-			/** If the current super kmer is finished (or max size reached), we dump it. */
-			if (h != superKmer.minimizer || superKmer.size() >= (size_t)maxs)
-			{
-				caller->processSuperkmer (superKmer);
-				superKmer.reset();
-			}
-			
-			/** We update the superkmer properties (minimizer value and kmers range). */
-			superKmer.minimizer    = h;
-			superKmer.addKmer(kmer);
-			
-		}
-	};
-	
-	
-	
     void operator() (bank::Sequence& sequence)
     {
         /** We update statistics about the bank. */
@@ -149,9 +91,51 @@ public:
         /** We create a superkmer object. */
         SuperKmer superKmer (_kmersize, _miniSize);
 
-		//iteration et traitement au fil de l'eau, without large kmer buffer (only small buffer for superkmer now )
-		_model.iterate(sequence.getData(), KmerFunctor<KmerType>(this,superKmer,maxs));
-		
+		/** We compute all the kmers of the sequence with their minimizers in one pass. */
+		_model.build (sequence.getData(), _kmers, _window);
+
+		/** We cut the kmers into superkmers, ie. ranges of valid kmers with the same minimizer;
+		 * the superkmers are ranges of the kmers buffer, so the kmers are not copied. */
+		size_t begin = 0;
+
+		for (size_t i=0; i<_kmers.size(); i++)
+		{
+			const KmerType& kmer = _kmers[i];
+
+			if (kmer.isValid() == false)
+			{
+				/** On invalid kmer : output the previous superkmer. */
+				superKmer.setRange (_kmers.data() + begin, i-begin);
+				processSuperkmer (superKmer);
+
+				superKmer.minimizer = DEFAULT_MINIMIZER;  //marking will have to restart 'from new'
+				begin = i+1;
+
+				_bankStatsLocal.kmersNbInvalid ++;
+				continue;
+			}
+
+			_bankStatsLocal.kmersNbValid ++;
+
+			/** We get the value of the current minimizer. */
+			u_int64_t h = kmer.minimizer().value().getVal();
+
+			/** We have to set minimizer value if not defined. */
+			if (superKmer.isValid() == false)  {  superKmer.minimizer = h;  }
+
+			/** If the current super kmer is finished (or max size reached), we dump it. */
+			if (h != superKmer.minimizer || i-begin >= (size_t)maxs)
+			{
+				superKmer.setRange (_kmers.data() + begin, i-begin);
+				processSuperkmer (superKmer);
+				begin = i;
+			}
+
+			superKmer.minimizer = h;
+		}
+
+		superKmer.setRange (_kmers.data() + begin, _kmers.size()-begin);
+
         //output last superK
         processSuperkmer (superKmer);
 
@@ -197,6 +181,10 @@ protected:
     BankStats&       _bankStatsGlobal;
     BankStats        _bankStatsLocal;
 
+    /** Buffers for the kmers of the current sequence (reused from one sequence to another). */
+    std::vector<KmerType>    _kmers;
+    typename Model::Window   _window;
+
     /** Primitive of the template method operator() */
     virtual void processSuperkmer (SuperKmer& superKmer) { _nbSuperKmers++; }
 };
@@ -220,14 +220,14 @@ IOptionsParser* SortingCountAlgorithm<span>::getOptionsParser (bool mandatory)
     parser->push_back (new OptionOneParam (STR_URI_OUTPUT_DIR,    "output directory",                               false, "."));
     parser->push_back (new OptionOneParam (STR_URI_OUTPUT_TMP,    "output directory for temporary files",           false, "."));
     parser->push_back (new OptionOneParam (STR_COMPRESS_LEVEL,    "h5 compression level (0:none, 9:best)",          false, "0"));
-    parser->push_back (new OptionOneParam (STR_STORAGE_TYPE,      "storage type of kmer counts ('hdf5' or 'file')", false, "hdf5"  ));
+    parser->push_back (new OptionOneParam (STR_STORAGE_TYPE,      "storage type of kmer counts ('hdf5', 'file' or 'packed')", false, "hdf5"  ));
 	parser->push_back (new OptionOneParam (STR_HISTO2D,"compute the 2D histogram (with first file = genome, remaining files = reads)",false,"0"));
 	parser->push_back (new OptionOneParam (STR_HISTO,"output the kmer abundance histogram",false,"0"));
 	parser->push_back (new OptionNoParam  (STR_KFF,"also output kmers in kff format",false));
 
     IOptionsParser* devParser = new OptionsParser ("kmer count, advanced performance tweaks");
 
-    devParser->push_back (new OptionOneParam (STR_MINIMIZER_TYPE,    "minimizer type (0=lexi, 1=freq)",                false, "0"));
+    devParser->push_back (new OptionOneParam (STR_MINIMIZER_TYPE,    "minimizer type (0=lexi, 1=freq, 2=random, 3=decycling set)", false, "0"));
     devParser->push_back (new OptionOneParam (STR_MINIMIZER_SIZE,    "size of a minimizer",                            false, "10"));
     devParser->push_back (new OptionOneParam (STR_REPARTITION_TYPE,  "minimizer repartition (0=unordered, 1=ordered)", false, "0"));
     parser->push_back (devParser);
@@ -554,6 +554,8 @@ void SortingCountAlgorithm<span>::configure ()
         {
             if (storage_type == "file")
                 _storage_type = tools::storage::impl::STORAGE_FILE;
+            else if (storage_type == "packed")
+                _storage_type = tools::storage::impl::STORAGE_PACKED_FILE;
             else
             {std::cout << "Error: unknown storage type specified: " << storage_type << std::endl; exit(1); }
         }
@@ -586,6 +588,8 @@ void SortingCountAlgorithm<span>::configure ()
                 );
         repart.execute ();
         setRepartitor (new Repartitor(storage->getGroup("minimizers")));
+
+        _config._estimatedDistinctKmersNb = repart.getEstimatedDistinctKmersNb();
     }
 
 	
@@ -740,6 +744,7 @@ void SortingCountAlgorithm<span>::execute ()
         getInfo()->add (2, "kmers");
         getInfo()->add (3, "kmers_nb_valid",   "%lld", _bankStats.kmersNbValid);
         getInfo()->add (3, "kmers_nb_invalid", "%lld", _bankStats.kmersNbInvalid);
+        if (_config._estimatedDistinctKmersNb > 0)  {  getInfo()->add (3, "kmers_nb_distinct_estimated", "%lld", _config._estimatedDistinctKmersNb);  }
 		
 		
     }
@@ -1247,11 +1252,11 @@ void SortingCountAlgorithm<span>::fillPartitions (size_t pass, Iterator<Sequence
 		/** We update the message of the progress bar. */
 		_progress->setMessage (Stringify::format(progressFormat1, pass+1, _config._nb_passes));
 		
-		/** We create a kmer model; using the frequency order if we're in that mode */
+		/** We create a kmer model; using the frequency (or another) order if we're in that mode */
 		uint32_t* freq_order = NULL;
 		
-		/** We may have to retrieve the minimizers frequencies computed in the RepartitorAlgorithm. */
-		if (_config._minimizerType == 1)  {  freq_order = _repartitor->getMinimizerFrequencies ();  }
+		/** We may have to retrieve the minimizers order computed in the RepartitorAlgorithm. */
+		if (_config._minimizerType != MinimizerOrder::LEXICOGRAPHIC)  {  freq_order = _repartitor->getMinimizerFrequencies ();  }
 		
 		Model model( _config._kmerSize, _config._minim_size, typename kmer::impl::Kmer<span>::ComparatorMinimizerFrequencyOrLex(), freq_order);
 		
@@ -29,6 +29,7 @@
 #include <gatb/system/api/types.hpp>
 #include <gatb/system/api/ISmartPointer.hpp>
 #include <string>
+#include <vector>
 
 /********************************************************************************/
 namespace gatb      {
@@ -66,6 +67,29 @@ public:
      * \return the number of cores. */
     virtual size_t getNbCores () const = 0;
 
+    /** Returns the number of NUMA nodes (1 if the machine is not NUMA or if unknown).
+     * \return the number of NUMA nodes. */
+    virtual size_t getNbNumaNodes () const = 0;
+
+    /** Returns the cores attached to a NUMA node.
+     * \param[in] node : index of the NUMA node, in [0,getNbNumaNodes()[
+     * \return the cores ids of the node. */
+    virtual std::vector<size_t> getNumaNodeCores (size_t node) const = 0;
+
+    /** CPU features that may be used by some kernels (see tools::math::Kernels). */
+    enum CpuFeature
+    {
+        CPU_POPCNT   = 1 << 0,
+        CPU_SSE42    = 1 << 1,
+        CPU_AVX2     = 1 << 2,
+        CPU_BMI2     = 1 << 3,
+        CPU_AVX512BW = 1 << 4
+    };
+
+    /** Returns the features of the CPU running the process.
+     * \return a combination of CpuFeature flags (0 if unknown). */
+    virtual u_int32_t getCpuFeatures () const = 0;
+
     /** Returns the host name.
      * \return the host name. */
     virtual std::string getHostName () const = 0;
@@ -28,6 +28,7 @@
 
 #include <gatb/system/api/types.hpp>
 #include <gatb/system/api/ISmartPointer.hpp>
+#include <vector>
 #include <gatb/system/api/Exception.hpp>
 #include <string>
 #include <list>
@@ -183,6 +184,11 @@ public:
     /** Return the id of the current process. */
     virtual u_int64_t getProcess () = 0;
 
+    /** Restrict the calling thread to a set of cores.
+     * \param[in] cores : ids of the allowed cores (see ISystemInfo::getNumaNodeCores)
+     * \return false if the binding is not supported or failed. */
+    virtual bool setAffinity (const std::vector<size_t>& cores) = 0;
+
     /** Destructor. */
     virtual ~IThreadFactory ()  {}
 };
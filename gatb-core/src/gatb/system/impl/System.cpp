@@ -40,7 +40,7 @@ static int mutex_inited = 0;
 ** REMARKS :
 *********************************************************************/
 ThreadGroup::ThreadGroup()
-:  _startSynchro(0)
+:  _startSynchro(0), _ownThreads(true)
 {
 	init_mutex_if_needed();
 	
@@ -61,7 +61,7 @@ ThreadGroup::~ThreadGroup()
     if (_startSynchro)  { delete _startSynchro; }
 
     /** We delete each thread. */
-    for (std::vector<system::IThread*>::iterator it = _threads.begin(); it != _threads.end(); it++)
+    for (std::vector<system::IThread*>::iterator it = _threads.begin(); _ownThreads && it != _threads.end(); it++)
     {
         delete (*it);
     }
@@ -146,6 +146,34 @@ IThreadGroup* ThreadGroup::create ()
     return tg;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+IThreadGroup* ThreadGroup::create (const std::vector<IThread*>& threads)
+{
+	init_mutex_if_needed();
+
+    LOCK();
+
+    ThreadGroup* tg = new ThreadGroup;
+    tg->_threads    = threads;
+    tg->_ownThreads = false;
+
+    /** The threads are already running: the start synchronizer is not used. */
+    if (tg->_startSynchro)  { tg->_startSynchro->unlock(); }
+
+    _groups.push_back(tg);
+
+    UNLOCK();
+
+    return tg;
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -174,6 +174,12 @@ public:
 	/** Create a IThreadGroup instance
 	 * \return the IThreadGroup instance */
     static IThreadGroup* create ();
+
+	/** Create a IThreadGroup instance made of existing threads (see the threads pool of Dispatcher).
+	 * The group doesn't own these threads: it neither starts, joins nor deletes them.
+	 * \param[in] threads : the threads of the group
+	 * \return the IThreadGroup instance */
+    static IThreadGroup* create (const std::vector<IThread*>& threads);
 	
 	/** Destroy a IThreadGroup */
     static void destroy (IThreadGroup* thr);
@@ -226,6 +232,7 @@ private:
 
     std::vector<IThread*>  _threads;
     system::ISynchronizer* _startSynchro;
+    bool                   _ownThreads;
 
     static std::list<ThreadGroup*> _groups;
 
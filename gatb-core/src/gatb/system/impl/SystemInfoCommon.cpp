@@ -105,6 +105,30 @@ std::string SystemInfoCommon::getBuildOptions () const { return STR_COMPILATION_
 
 std::string SystemInfoCommon::getBuildSystem () const { return STR_OPERATING_SYSTEM; }
 
+std::vector<size_t> SystemInfoCommon::getNumaNodeCores (size_t node) const
+{
+    std::vector<size_t> result;
+    if (node == 0)  {  for (size_t i=0; i<getNbCores(); i++)  { result.push_back(i); }  }
+    return result;
+}
+
+/********************************************************************************/
+u_int32_t SystemInfoCommon::getCpuFeatures () const
+{
+    u_int32_t result = 0;
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    __builtin_cpu_init ();
+    if (__builtin_cpu_supports ("popcnt"))    { result |= CPU_POPCNT;   }
+    if (__builtin_cpu_supports ("sse4.2"))    { result |= CPU_SSE42;    }
+    if (__builtin_cpu_supports ("avx2"))      { result |= CPU_AVX2;     }
+    if (__builtin_cpu_supports ("bmi2"))      { result |= CPU_BMI2;     }
+    if (__builtin_cpu_supports ("avx512bw"))  { result |= CPU_AVX512BW; }
+#endif
+
+    return result;
+}
+
 /*********************************************************************
                 #        ###  #     #  #     #  #     #
                 #         #   ##    #  #     #   #   #
@@ -141,6 +165,55 @@ size_t SystemInfoLinux::getNbCores () const
     return result;
 }
 
+/********************************************************************************/
+size_t SystemInfoLinux::getNbNumaNodes () const
+{
+    size_t result = 0;
+
+    /** Nodes are numbered contiguously in sysfs; no such directory means no NUMA support. */
+    char path[128];
+    for ( ; ; result++)
+    {
+        snprintf (path, sizeof(path), "/sys/devices/system/node/node%zu", result);
+        if (access (path, F_OK) != 0)  { break; }
+    }
+
+    if (result==0)  { result = 1; }
+
+    return result;
+}
+
+/********************************************************************************/
+std::vector<size_t> SystemInfoLinux::getNumaNodeCores (size_t node) const
+{
+    std::vector<size_t> result;
+
+    char path[128];
+    snprintf (path, sizeof(path), "/sys/devices/system/node/node%zu/cpulist", node);
+
+    /** The cpulist file holds ranges like "0-3,8-11". */
+    FILE* file = fopen (path, "r");
+    if (file)
+    {
+        unsigned long first, last;
+        while (fscanf (file, "%lu", &first) == 1)
+        {
+            last = first;
+            int c = fgetc (file);
+            if (c == '-')  {  if (fscanf (file, "%lu", &last) != 1)  { break; }  c = fgetc (file);  }
+            for (size_t i=first; i<=last; i++)  { result.push_back(i); }
+            if (c != ',')  { break; }
+        }
+        fclose (file);
+    }
+    else
+    {
+        result = SystemInfoCommon::getNumaNodeCores (node);
+    }
+
+    return result;
+}
+
 /********************************************************************************/
 string SystemInfoLinux::getHostName () const
 {
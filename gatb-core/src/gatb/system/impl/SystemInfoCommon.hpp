@@ -67,6 +67,15 @@ public:
     /** \copydoc ISystemInfo::getBuildSystem */
     std::string getBuildSystem () const;
 
+    /** \copydoc ISystemInfo::getNbNumaNodes */
+    size_t getNbNumaNodes () const  { return 1; }
+
+    /** \copydoc ISystemInfo::getNumaNodeCores */
+    std::vector<size_t> getNumaNodeCores (size_t node) const;
+
+    /** \copydoc ISystemInfo::getCpuFeatures */
+    u_int32_t getCpuFeatures () const;
+
     /** \copydoc ISystemInfo::getHomeDirectory */
     std::string getHomeDirectory ()  const {  return getenv("HOME") ? getenv("HOME") : ".";  }
     
@@ -97,6 +106,12 @@ public:
     /** \copydoc ISystemInfo::getNbCores */
     size_t getNbCores () const ;
 
+    /** \copydoc ISystemInfo::getNbNumaNodes */
+    size_t getNbNumaNodes () const ;
+
+    /** \copydoc ISystemInfo::getNumaNodeCores */
+    std::vector<size_t> getNumaNodeCores (size_t node) const ;
+
     /** \copydoc ISystemInfo::getHostName */
     std::string getHostName () const ;
 
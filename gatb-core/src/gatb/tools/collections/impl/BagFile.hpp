@@ -29,6 +29,7 @@
 /********************************************************************************/
 
 #include <gatb/tools/collections/api/Bag.hpp>
+#include <gatb/tools/collections/impl/PackedCountCodec.hpp>
 #include <gatb/system/impl/System.hpp>
 
 #include <string>
@@ -295,6 +296,102 @@ private:
     size_t _buffer_size;
 };
     
+
+/********************************************************************************/
+
+/** \brief Bag implementation for a file of [kmer,abundance] items, see PackedCountCodec.
+ *
+ * Items are expected to be inserted sorted by kmer value (as the solid kmers of a DSK partition);
+ * they are buffered and written by blocks.
+ *
+ * The file is created (with its header) if it doesn't exist yet; otherwise items are appended to it.
+ */
+template <typename Item> class BagPackedCountFile : public Bag<Item>, public system::SmartPointer
+{
+public:
+
+    typedef PackedCountCodec<Item> Codec;
+
+    /** Constructor. */
+    BagPackedCountFile (const std::string& filename) : _filename(filename), _file(0)
+    {
+        if (system::impl::System::file().doesExist(filename) == false)
+        {
+            _file = system::impl::System::file().newFile (filename, "wb");
+            _file->fwrite (Codec::magic(), 1, Codec::MAGIC_SIZE);
+            _file->flush();
+        }
+        _pending.reserve (Codec::BLOCK_SIZE);
+    }
+
+    /** Destructor. */
+    ~BagPackedCountFile ()
+    {
+        flush ();
+        if (_file)  { delete _file; }
+    }
+
+    /** Get the name of the file.
+     * \return the file name.  */
+    const std::string& getName () const { return _filename; }
+
+    /**  \copydoc Bag::insert */
+    void insert (const Item& item)
+    {
+        if (!_pending.empty() && item.value < _pending.back().value)  { encodePending(); }
+
+        _pending.push_back (item);
+
+        if (_pending.size() == Codec::BLOCK_SIZE)  { encodePending(); }
+    }
+
+    /**  \copydoc Bag::insert(const std::vector<Item>& items, size_t length) */
+    void insert (const std::vector<Item>& items, size_t length)
+    {
+        if (length == 0)  { length = items.size(); }
+        insert (items.data(), length);
+    }
+
+    /**  \copydoc Bag::insert(const Item* items, size_t length) */
+    void insert (const Item* items, size_t length)
+    {
+        for (size_t i=0; i<length; i++)  { insert (items[i]); }
+    }
+
+    /**  \copydoc Bag::flush */
+    void flush ()
+    {
+        encodePending ();
+        writeBuffer ();
+        if (_file)  { _file->flush(); }
+    }
+
+private:
+
+    void encodePending ()
+    {
+        Codec::encode (_pending.data(), _pending.size(), _buffer);
+        _pending.clear();
+
+        if (_buffer.size() >= (1<<16))  { writeBuffer(); }
+    }
+
+    void writeBuffer ()
+    {
+        if (_buffer.empty())  { return; }
+
+        /** The file is opened only when something is written (the collection may be opened only for reading). */
+        if (_file == 0)  { _file = system::impl::System::file().newFile (_filename, "ab"); }
+
+        _file->fwrite (_buffer.data(), 1, _buffer.size());
+        _buffer.clear();
+    }
+
+    std::string           _filename;
+    system::IFile*        _file;
+    std::vector<Item>     _pending;
+    std::vector<u_int8_t> _buffer;
+};
     
 /********************************************************************************/
 } } } } } /* end of namespaces. */
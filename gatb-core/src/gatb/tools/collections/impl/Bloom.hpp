@@ -31,6 +31,7 @@
 #include <gatb/tools/collections/api/Container.hpp>
 #include <gatb/tools/collections/api/Bag.hpp>
 #include <gatb/tools/math/LargeInt.hpp>
+#include <gatb/tools/math/Kernels.hpp>
 #include <gatb/system/impl/System.hpp>
 #include <gatb/system/api/types.hpp>
 #include <gatb/tools/misc/api/Enums.hpp>
@@ -51,7 +52,16 @@ extern u_int8_t bit_mask [];
  *
  * This class defines a set of hash functions for a given (template) type.
  *
- * One can get a hash code for a given [function,item] through the operator()
+ * One can get a hash code for a given [function,item] through the operator(), or the
+ * codes of all the functions for an item through the Codes iterator.
+ *
+ * Two versions of the functions exist:
+ *  - version 1: each function is a hash1 with its own seed, so nbFct hashes for an item
+ *  - version 2: one wyhash is computed for an item, and the functions are derived from it by
+ *    double hashing (Kirsch & Mitzenmacher): code_i = h + i.delta, where delta is odd and made
+ *    of the other half of the bits of h.
+ *
+ * New instances use version 2; version 1 is kept for reading Bloom filters saved with it.
  *
  * Note: this class is mainly used by Bloom filters implementations. It is not
  * primarly targeted for end users but they could nevertheless use it.
@@ -60,19 +70,70 @@ template <typename Item> class HashFunctors
 {
 public:
 
+    /** Version of the hash functions of new instances. */
+    static const int CURRENT_VERSION = 2;
+
     /** Constructor.
      * \param[in] nbFct : number of hash functions to be used
      * \param[in] seed : some initialization code for defining the hash functions. */
-    HashFunctors (size_t nbFct, u_int64_t seed=0) : _nbFct(nbFct), user_seed(seed)
+    HashFunctors (size_t nbFct, u_int64_t seed=0) : _nbFct(nbFct), user_seed(seed), _version(CURRENT_VERSION)
     {
         generate_hash_seed ();
     }
 
+    /** Get the version of the hash functions.
+     * \return the version. */
+    int getVersion () const  { return _version; }
+
+    /** Set the version of the hash functions.
+     * \param[in] version : 1 or 2 */
+    void setVersion (int version)
+    {
+        if (version < 1 || version > CURRENT_VERSION)  { throw system::Exception ("bad hash functions version %d", version); }
+        _version = version;
+    }
+
     /** Get a hash code for a hash function and a given item.
      * \param[in] key : item for which we want a hash code
      * \param[in] idx : index of the hash function to be used
      * \return the hash code for the item. */
-    u_int64_t operator ()  (const Item& key, size_t idx)  {  return hash1 (key, seed_tab[idx]);  }
+    u_int64_t operator ()  (const Item& key, size_t idx)  {  return *Codes (*this, key, idx);  }
+
+    /** \brief Hash codes of an item for the successive hash functions.
+     *
+     * The codes are got with operator* and the next function is selected with operator++.
+     * With version 2, the item is hashed once at construction. */
+    class Codes
+    {
+    public:
+
+        /** Constructor.
+         * \param[in] ref : the hash functions
+         * \param[in] key : the item to be hashed
+         * \param[in] idx : index of the first hash function. */
+        Codes (const HashFunctors& ref, const Item& key, size_t idx=0) : _ref(ref), _key(key), _idx(idx), _code(0), _delta(0)
+        {
+            if (_ref._version >= 2)
+            {
+                u_int64_t h = wyhash (key, _ref.user_seed);
+                _delta = ((h >> 32) | (h << 32)) | 1;
+                _code  = h + idx * _delta;
+            }
+        }
+
+        /** \return the hash code for the current function. */
+        u_int64_t operator* () const  {  return _ref._version >= 2 ? _code : hash1 (_key, _ref.seed_tab[_idx]);  }
+
+        /** Select the next hash function. */
+        Codes& operator++ ()  {  _idx++;  _code += _delta;  return *this;  }
+
+    private:
+        const HashFunctors& _ref;
+        const Item&         _key;
+        size_t              _idx;
+        u_int64_t           _code;
+        u_int64_t           _delta;
+    };
 
 private:
 
@@ -95,6 +156,7 @@ private:
     static const size_t NSEEDSBLOOM = 10;
     u_int64_t seed_tab[NSEEDSBLOOM];
     u_int64_t user_seed;
+    int       _version;
 };
 
 /********************************************************************************/
@@ -133,6 +195,15 @@ public:
      * \return the number of hash functions. */
     virtual size_t     getNbHash   () const = 0;
 
+    /** Get the version of the hash functions used for the Bloom filter (see HashFunctors).
+     * \return the version of the hash functions. */
+    virtual int        getHashVersion () const = 0;
+
+    /** Set the version of the hash functions used for the Bloom filter. This is needed
+     * when a Bloom filter saved with older hash functions is loaded.
+     * \param[in] version : the version of the hash functions. */
+    virtual void       setHashVersion (int version) = 0;
+
     /** Tells whether an item is in the Bloom filter
      * \param[in] item : item to test.
      * \return the presence or not of the item
@@ -207,14 +278,21 @@ public:
     /** \copydoc IBloom::getNbHash */
     size_t getNbHash () const { return n_hash_func; }
 
+    /** \copydoc IBloom::getHashVersion */
+    int getHashVersion () const { return _hash.getVersion(); }
+
+    /** \copydoc IBloom::setHashVersion */
+    void setHashVersion (int version)  { _hash.setVersion (version); }
+
     /** \copydoc Container::contains. */
     bool contains (const Item& item)
     {
         if (isSizePowOf2)
         {
-            for (size_t i=0; i<n_hash_func; i++)
+            typename HashFunctors<Item>::Codes code (_hash, item);
+            for (size_t i=0; i<n_hash_func; i++, ++code)
             {
-                u_int64_t h1 = _hash (item,i) & tai;
+                u_int64_t h1 = *code & tai;
                // if ((blooma[h1 >> 3 ] & bit_mask[h1 & 7]) != bit_mask[h1 & 7])  {  return false;  }
 				if ((blooma[h1 >> 3 ] & bit_mask[h1 & 7]) == 0)  {  return false;  }
 
@@ -222,9 +300,10 @@ public:
         }
         else
         {
-            for (size_t i=0; i<n_hash_func; i++)
+            typename HashFunctors<Item>::Codes code (_hash, item);
+            for (size_t i=0; i<n_hash_func; i++, ++code)
             {
-                u_int64_t h1 = _hash (item,i) % tai;
+                u_int64_t h1 = *code % tai;
                // if ((blooma[h1 >> 3 ] & bit_mask[h1 & 7]) != bit_mask[h1 & 7])  {  return false;  }
 				if ((blooma[h1 >> 3 ] & bit_mask[h1 & 7]) == 0)  {  return false;  }
 
@@ -279,17 +358,19 @@ public:
     {
         if (this->isSizePowOf2)
         {
-            for (size_t i=0; i<this->n_hash_func; i++)
+            typename HashFunctors<Item>::Codes code (this->_hash, item);
+            for (size_t i=0; i<this->n_hash_func; i++, ++code)
             {
-                u_int64_t h1 = this->_hash (item,i) & this->tai;
+                u_int64_t h1 = *code & this->tai;
                 this->blooma [h1 >> 3] |= bit_mask[h1 & 7];
             }
         }
         else
         {
-            for (size_t i=0; i<this->n_hash_func; i++)
+            typename HashFunctors<Item>::Codes code (this->_hash, item);
+            for (size_t i=0; i<this->n_hash_func; i++, ++code)
             {
-                u_int64_t h1 = this->_hash (item,i) % this->tai;
+                u_int64_t h1 = *code % this->tai;
                 this->blooma [h1 >> 3] |= bit_mask[h1 & 7];
             }
         }
@@ -314,15 +395,7 @@ public:
     /** \copydoc IBloom::weight */
     unsigned long weight()
     {
-        const unsigned char oneBits[] = {0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4};
-        long weight = 0;
-        for(uint64_t index = 0; index < this->nchar; index++)
-        {
-            unsigned char current_char = this->blooma[index];
-            weight += oneBits[current_char&0x0f];
-            weight += oneBits[current_char>>4];
-        }
-        return weight;
+        return math::Kernels::singleton().popcount (this->blooma, this->nchar);
     }
 };
 
@@ -351,6 +424,12 @@ public:
     /** \copydoc IBloom::getNbHash */
     size_t     getNbHash   () const { return 0; }
 
+    /** \copydoc IBloom::getHashVersion */
+    int        getHashVersion () const { return HashFunctors<Item>::CURRENT_VERSION; }
+
+    /** \copydoc IBloom::setHashVersion */
+    void       setHashVersion (int version)  {}
+
     /** \copydoc IBloom::getName */
     virtual std::string  getName   () const  { return "BloomNull"; }
 
@@ -395,17 +474,19 @@ public:
     {
         if (this->isSizePowOf2)
         {
-            for (size_t i=0; i<this->n_hash_func; i++)
+            typename HashFunctors<Item>::Codes code (this->_hash, item);
+            for (size_t i=0; i<this->n_hash_func; i++, ++code)
             {
-                u_int64_t h1 = this->_hash (item,i) & this->tai;
+                u_int64_t h1 = *code & this->tai;
                 __sync_fetch_and_or (this->blooma + (h1 >> 3), bit_mask[h1 & 7]);
             }
         }
         else
         {
-            for (size_t i=0; i<this->n_hash_func; i++)
+            typename HashFunctors<Item>::Codes code (this->_hash, item);
+            for (size_t i=0; i<this->n_hash_func; i++, ++code)
             {
-                u_int64_t h1 = this->_hash (item,i) % this->tai;
+                u_int64_t h1 = *code % this->tai;
                 __sync_fetch_and_or (this->blooma + (h1 >> 3), bit_mask[h1 & 7]);
             }
         }
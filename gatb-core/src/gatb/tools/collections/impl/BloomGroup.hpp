@@ -71,9 +71,10 @@ public:
     {
         static const Result ONE (1);
 
-        for (size_t i=0; i<this->_nbHash; i++)
+        typename HashFunctors<Item>::Codes code (this->_hash, item);
+        for (size_t i=0; i<this->_nbHash; i++, ++code)
         {
-            u_int64_t h1 = this->_hash (item, i) % this->_size;
+            u_int64_t h1 = *code % this->_size;
 #if 1
             this->_blooma[h1] |= (ONE << idx);
 #else
@@ -142,9 +143,10 @@ for (size_t i=0; i<10; i++)
     bool contains (const Item& item, size_t idx)
     {
         static const Result ONE (1);
-        for (size_t i=0; i<this->_nbHash; i++)
+        typename HashFunctors<Item>::Codes code (this->_hash, item);
+        for (size_t i=0; i<this->_nbHash; i++, ++code)
         {
-            u_int64_t h1 = this->_hash (item, i) % this->_size;
+            u_int64_t h1 = *code % this->_size;
             if ( (_blooma[h1] & (ONE << idx)) != (ONE << idx) )  {  return false;  }
         }
         return true;
@@ -156,9 +158,10 @@ for (size_t i=0; i<10; i++)
         static const Result ZERO (0);
         Result res = ~ZERO;
 
-        for (size_t i=0; i<this->_nbHash; i++)
+        typename HashFunctors<Item>::Codes code (this->_hash, item);
+        for (size_t i=0; i<this->_nbHash; i++, ++code)
         {
-            u_int64_t h1 = this->_hash (item, i) % this->_size;
+            u_int64_t h1 = *code % this->_size;
             res &= _blooma [h1];
         }
         return res;
@@ -286,9 +289,10 @@ public:
     {
         u_int64_t q,mask;  euclidian(idx,q,mask);
 
-        for (size_t i=0; i<this->_nbHash; i++)
+        typename HashFunctors<Item>::Codes code (this->_hash, item);
+        for (size_t i=0; i<this->_nbHash; i++, ++code)
         {
-            u_int64_t h1 = this->_hash (item, i) % this->_size;
+            u_int64_t h1 = *code % this->_size;
 
 #if 1
             this->_blooma[h1][q] |= mask;
@@ -303,9 +307,10 @@ public:
     {
         u_int64_t q,mask;  euclidian(idx,q,mask);
 
-        for (size_t i=0; i<this->_nbHash; i++)
+        typename HashFunctors<Item>::Codes code (this->_hash, item);
+        for (size_t i=0; i<this->_nbHash; i++, ++code)
         {
-            u_int64_t h1 = this->_hash (item, i) % this->_size;
+            u_int64_t h1 = *code % this->_size;
             if ( (_blooma[h1][q] & mask) != mask )  {  return false;  }
         }
         return true;
@@ -316,9 +321,10 @@ public:
     {
         Result res (~0);
 
-        for (size_t i=0; i<this->_nbHash; i++)
+        typename HashFunctors<Item>::Codes code (this->_hash, item);
+        for (size_t i=0; i<this->_nbHash; i++, ++code)
         {
-            u_int64_t h1 = this->_hash (item, i) % this->_size;
+            u_int64_t h1 = *code % this->_size;
             res &=  _blooma [h1];
         }
         return res;
@@ -195,7 +195,13 @@ public:
     /** Insert an item into the hash table
      * \param[in] graine : key
      */
-    void insert (Item graine)
+    void insert (Item graine)  {  add (graine, 1);  }
+
+    /** Add some count to an item of the hash table (inserted with this count if not found)
+     * \param[in] graine : key
+     * \param[in] value : count to be added
+     */
+    void add (Item graine, value_type value)
     {
         unsigned int clef ;
         cell* cell_ptr, *newcell_ptr;
@@ -215,7 +221,7 @@ public:
             newcell_internal_ptr = storage.allocate_cell();
 
             newcell_ptr         = storage.internal_ptr_to_cell_pointer(newcell_internal_ptr);
-            newcell_ptr->val    = 1;
+            newcell_ptr->val    = value;
             newcell_ptr->graine = graine;
             newcell_ptr->suiv   = datah[clef];
 
@@ -225,7 +231,7 @@ public:
         }
         else
         {
-            (cell_ptr->val)++;  // graine trouvee
+            cell_ptr->val += value;  // graine trouvee
         }
     }
 
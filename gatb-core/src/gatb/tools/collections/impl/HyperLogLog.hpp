@@ -0,0 +1,145 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file HyperLogLog.hpp
+ *  \brief Estimation of the number of distinct items of a stream
+ */
+
+#ifndef _GATB_CORE_TOOLS_COLLECTIONS_IMPL_HYPERLOGLOG_HPP_
+#define _GATB_CORE_TOOLS_COLLECTIONS_IMPL_HYPERLOGLOG_HPP_
+
+/********************************************************************************/
+
+#include <gatb/system/api/types.hpp>
+#include <gatb/system/api/Exception.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+/********************************************************************************/
+namespace gatb          {
+namespace core          {
+namespace tools         {
+namespace collections   {
+namespace impl          {
+/********************************************************************************/
+
+/** \brief HyperLogLog sketch of 64 bits hash codes.
+ *
+ * The sketch has 2^precision registers of one byte, whatever the number of items: the
+ * relative standard error of the estimation is about 1.04/sqrt(2^precision), ie. 0.4% for
+ * the default precision of 16 (64 KB of registers).
+ *
+ * The items are given by their hash codes (see for instance the wyhash functions of the
+ * math module), which must be well distributed on 64 bits. With 64 bits codes, there is no
+ * large range correction to be done; the estimation uses the improved estimator of O. Ertl
+ * ("New cardinality estimation algorithms for HyperLogLog sketches", 2017), which is also
+ * accurate for small cardinalities without bias tables.
+ *
+ * Sketches of the same precision can be merged, so each thread may fill its own sketch
+ * and the sketches are merged at the end: the result is the one of a single sketch that
+ * would have received all the items.
+ */
+class HyperLogLog
+{
+public:
+
+    /** Constructor.
+     * \param[in] precision : log2 of the number of registers, in [4,18] */
+    HyperLogLog (size_t precision = 16) : _precision(precision), _registers ((size_t)1 << precision, 0)
+    {
+        if (precision < 4 || precision > 18)  {  throw system::Exception ("HyperLogLog: bad precision %d", precision);  }
+    }
+
+    /** Get the precision of the sketch.
+     * \return log2 of the number of registers. */
+    size_t getPrecision () const  { return _precision; }
+
+    /** Add an item to the sketch.
+     * \param[in] hash : hash code of the item */
+    void insert (u_int64_t hash)
+    {
+        /** The first bits give the register, the rank is the position of the first bit set in the others. */
+        u_int64_t w    = hash << _precision;
+        u_int8_t  rank = w==0 ? (u_int8_t) (64 - _precision + 1) : (u_int8_t) (__builtin_clzll (w) + 1);
+
+        u_int8_t& reg = _registers[hash >> (64 - _precision)];
+        if (rank > reg)  { reg = rank; }
+    }
+
+    /** Merge another sketch into this one.
+     * \param[in] other : sketch of the same precision */
+    void merge (const HyperLogLog& other)
+    {
+        if (other._precision != _precision)  {  throw system::Exception ("HyperLogLog: merge of sketches of different precisions");  }
+
+        for (size_t i=0; i<_registers.size(); i++)  {  if (other._registers[i] > _registers[i])  { _registers[i] = other._registers[i]; }  }
+    }
+
+    /** Reset the sketch. */
+    void clear ()  {  std::fill (_registers.begin(), _registers.end(), 0);  }
+
+    /** Estimation of the number of distinct items inserted.
+     * \return the estimation. */
+    u_int64_t cardinality () const
+    {
+        size_t q = 64 - _precision;
+        double m = _registers.size();
+
+        /** Histogram of the registers values. */
+        std::vector<double> histo (q+2, 0);
+        for (size_t i=0; i<_registers.size(); i++)  {  histo[_registers[i]] ++;  }
+
+        double z = m * tau (1 - histo[q+1]/m);
+        for (size_t k=q; k>=1; k--)  {  z = 0.5 * (z + histo[k]);  }
+        z += m * sigma (histo[0]/m);
+
+        if (z == 0)  { return 0; }
+
+        return (u_int64_t) (0.5 / std::log(2.0) * m * m / z + 0.5);
+    }
+
+private:
+
+    static double sigma (double x)
+    {
+        if (x == 1)  { return HUGE_VAL; }
+        double y = 1, z = x, previous;
+        do  {  x *= x;  previous = z;  z += x * y;  y += y;  }  while (z != previous);
+        return z;
+    }
+
+    static double tau (double x)
+    {
+        if (x == 0 || x == 1)  { return 0; }
+        double y = 1, z = 1 - x, previous;
+        do  {  x = std::sqrt (x);  previous = z;  y *= 0.5;  z -= (1-x)*(1-x) * y;  }  while (z != previous);
+        return z / 3;
+    }
+
+    size_t                _precision;
+    std::vector<u_int8_t> _registers;
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_COLLECTIONS_IMPL_HYPERLOGLOG_HPP_ */
@@ -30,6 +30,7 @@
 
 #include <gatb/tools/designpattern/api/Iterator.hpp>
 #include <gatb/tools/collections/api/Iterable.hpp>
+#include <gatb/tools/collections/impl/PackedCountCodec.hpp>
 #include <gatb/system/impl/System.hpp>
 
 #include <string>
@@ -134,7 +135,10 @@ public:
     /** \copydoc dp::Iterator::item */
     Item& item ()  { return *(this->_item); }
 
-    /** */
+    /** Read the next items of the file by block, without going through first/next/item.
+     * \param[in] vec : vector to be filled
+     * \param[in] len : number of items to read (0 means vec.size())
+     * \return the number of items read. */
     size_t fill (std::vector<Item>& vec, size_t len=0)
     {
         if (len==0)  { len = vec.size(); }
@@ -529,6 +533,140 @@ private:
     size_t          _cacheItemsNb;
 };
 
+
+/********************************************************************************/
+
+/** \brief Iterator on a file written by BagPackedCountFile; items are decoded one block at a time.
+ */
+template <class Item> class IteratorPackedCountFile : public dp::Iterator<Item>
+{
+public:
+
+    typedef PackedCountCodec<Item> Codec;
+
+    /** Constructor. */
+    IteratorPackedCountFile (const std::string& filename) : _filename(filename), _file(0), _idx(0), _isDone(true)  {}
+
+    /** Destructor. */
+    ~IteratorPackedCountFile ()  {  if (_file)  { delete _file; }  }
+
+    /** \copydoc dp::Iterator::first */
+    void first()
+    {
+        /** The file is opened here since it may not exist when the iterator is created. */
+        if (_file == 0)  { _file = system::impl::System::file().newFile (_filename, "rb"); }
+
+        _file->seeko (Codec::MAGIC_SIZE, SEEK_SET);
+        _items.clear();
+        _idx    = 0;
+        _isDone = false;
+        next ();
+    }
+
+    /** \copydoc dp::Iterator::next */
+    void next()
+    {
+        if (_idx >= _items.size())
+        {
+            if (!readBlock())  { _isDone = true;  return; }
+            _idx = 0;
+        }
+        *(this->_item) = _items[_idx++];
+    }
+
+    /** \copydoc dp::Iterator::isDone */
+    bool isDone()  { return _isDone; }
+
+    /** \copydoc dp::Iterator::item */
+    Item& item ()  { return *(this->_item); }
+
+    /** Read the header of the next block of a packed count file.
+     * \param[in] file : the file
+     * \param[out] nbItems : number of items of the block
+     * \param[out] bodySize : size in bytes of the rest of the block
+     * \return false if the end of the file is reached. */
+    static bool readBlockHeader (system::IFile* file, u_int64_t& nbItems, u_int64_t& bodySize)
+    {
+        return readVarint (file, nbItems) && readVarint (file, bodySize);
+    }
+
+private:
+
+    std::string           _filename;
+    system::IFile*        _file;
+    std::vector<Item>     _items;
+    std::vector<u_int8_t> _body;
+    size_t                _idx;
+    bool                  _isDone;
+
+    bool readBlock ()
+    {
+        u_int64_t nbItems, bodySize;
+        if (!readBlockHeader (_file, nbItems, bodySize))  { return false; }
+
+        _body.resize (bodySize);
+        if (_file->fread (_body.data(), 1, bodySize) != bodySize)  { return false; }
+
+        Codec::decode (_body.data(), nbItems, _items);
+        return true;
+    }
+
+    static bool readVarint (system::IFile* file, u_int64_t& value)
+    {
+        value = 0;
+        for (int shift=0; ; shift+=7)
+        {
+            int byte = file->get();
+            if (byte == EOF)  { return false; }
+            value |= (u_int64_t)(byte & 127) << shift;
+            if (byte < 128)  { return true; }
+        }
+    }
+};
+
+/********************************************************************************/
+
+/** \brief Iterable on a file written by BagPackedCountFile.
+ */
+template <class Item> class IterablePackedCountFile : public tools::collections::Iterable<Item>, public virtual system::SmartPointer
+{
+public:
+
+    /** Constructor. */
+    IterablePackedCountFile (const std::string& filename) : _filename(filename)  {}
+
+    /** Destructor. */
+    ~IterablePackedCountFile () {}
+
+    /** \copydoc tools::collections::Iterable::iterator */
+    dp::Iterator<Item>* iterator ()  { return new IteratorPackedCountFile<Item> (_filename); }
+
+    /** Number of items, got from the headers of the blocks.
+     * \copydoc tools::collections::Iterable::getNbItems */
+    int64_t getNbItems ()
+    {
+        if (system::impl::System::file().doesExist(_filename) == false)  { return 0; }
+
+        system::IFile* file = system::impl::System::file().newFile (_filename, "rb");
+        file->seeko (PackedCountCodec<Item>::MAGIC_SIZE, SEEK_SET);
+
+        int64_t result = 0;
+        u_int64_t nbItems, bodySize;
+        while (IteratorPackedCountFile<Item>::readBlockHeader (file, nbItems, bodySize))
+        {
+            result += nbItems;
+            file->seeko (bodySize, SEEK_CUR);
+        }
+        delete file;
+        return result;
+    }
+
+    /** \copydoc tools::collections::Iterable::estimateNbItems */
+    int64_t estimateNbItems ()  {  return getNbItems();  }
+
+private:
+    std::string _filename;
+};
     
 /********************************************************************************/
 } } } } } /* end of namespaces. */
@@ -0,0 +1,263 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file KWayMerge.hpp
+ *  \brief Merge of N sorted streams with a loser tree
+ */
+
+#ifndef _GATB_CORE_TOOLS_COLLECTIONS_IMPL_KWAY_MERGE_HPP_
+#define _GATB_CORE_TOOLS_COLLECTIONS_IMPL_KWAY_MERGE_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/collections/impl/IteratorFile.hpp>
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <sys/types.h>
+
+/********************************************************************************/
+namespace gatb          {
+namespace core          {
+namespace tools         {
+namespace collections   {
+namespace impl          {
+/********************************************************************************/
+
+/** \brief Tournament tree of losers over N sorted sources.
+ *
+ * The tree only handles source indexes; the current items are kept by the caller and
+ * compared through the 'less' functor, called as less(i,j) with two source indexes.
+ * Each internal node keeps the loser of the match played there, so that selecting the
+ * next minimum after the winner source moved takes log2(N) comparisons on the path
+ * from this source to the root (a binary heap needs about twice as many, plus copies).
+ *
+ * Usage:
+ *  - prime each source, call setDone for the empty ones, then build
+ *  - while !isDone(): use the source top(), move it forward, then call replay
+ *    (or setDone(top()) then replay if the source is exhausted)
+ */
+template <typename Less> class LoserTree
+{
+public:
+
+    /** Constructor.
+     * \param[in] nbSources : number of sources to be merged.
+     * \param[in] less : comparison of the current items of two sources. */
+    LoserTree (size_t nbSources, const Less& less)
+        : _nb(nbSources), _less(less), _tree(std::max<size_t>(nbSources,1), 0), _done(nbSources, false)  {}
+
+    /** Tells that a source has no more item.
+     * \param[in] source : index of the source. */
+    void setDone (size_t source)  {  _done[source] = true;  }
+
+    /** Play all the matches. Must be called once all the sources are primed. */
+    void build ()
+    {
+        if (_nb == 0)  { return; }
+
+        /** Winners of the matches; leaves are at [nb,2*nb) */
+        std::vector<size_t> winners (2*_nb);
+        for (size_t i=0; i<_nb; i++)  {  winners[_nb+i] = i;  }
+
+        for (size_t n=_nb-1; n>=1; n--)
+        {
+            size_t a = winners[2*n], b = winners[2*n+1];
+            if (beats (a,b))  {  winners[n] = a;  _tree[n] = b;  }
+            else              {  winners[n] = b;  _tree[n] = a;  }
+        }
+        _tree[0] = _nb > 1 ? winners[1] : 0;
+    }
+
+    /** \return the index of the source holding the smallest item. */
+    size_t top () const  {  return _tree[0];  }
+
+    /** \return true if all the sources are exhausted. */
+    bool isDone () const  {  return _nb==0 || _done[_tree[0]];  }
+
+    /** Replay the matches of the top source, after its current item changed. */
+    void replay ()
+    {
+        size_t winner = _tree[0];
+        for (size_t n=(winner+_nb)/2; n>=1; n/=2)
+        {
+            if (beats (_tree[n], winner))  {  std::swap (_tree[n], winner);  }
+        }
+        _tree[0] = winner;
+    }
+
+private:
+
+    /** Exhausted sources lose against everybody. */
+    bool beats (size_t a, size_t b)  {  return !_done[a] && (_done[b] || !_less (b,a));  }
+
+    size_t              _nb;
+    Less                _less;
+    std::vector<size_t> _tree;
+    std::vector<bool>   _done;
+};
+
+/********************************************************************************/
+
+/** \brief Merge of N streams of [kmer,abundance] items sorted by kmer value.
+ *
+ * Items with the same value are aggregated: the abundances are summed (in 64 bits).
+ * The sources are read by blocks, so the merge loop works on plain arrays and only
+ * calls the sources once per block.
+ *
+ * Item is a misc::Abundance (or Kmer<span>::Count).
+ */
+template <typename Item> class CountMerger
+{
+public:
+
+    typedef typename Item::ValueType Value;
+
+    /** \brief Source of sorted items, read by blocks. */
+    class Source
+    {
+    public:
+        virtual ~Source () {}
+
+        /** Read the next items.
+         * \param[out] block : vector to be filled (its size is the maximum number of items to read)
+         * \return the number of items read, 0 at the end of the source. */
+        virtual size_t read (std::vector<Item>& block) = 0;
+    };
+
+    /** \brief Source reading a file of items (see BagFile). The items of the file may have
+     * a smaller abundance type than Item. */
+    template <typename FileItem=Item> class FileSource : public Source
+    {
+    public:
+        FileSource (const std::string& filename) : _it (filename, 1)  {}
+        size_t read (std::vector<Item>& block)  {  return fill (_it, block, _buffer);  }
+    private:
+        static size_t fill (IteratorFile<Item>& it, std::vector<Item>& block, std::vector<Item>& buffer)  {  return it.fill (block);  }
+
+        template <typename Other>
+        static size_t fill (IteratorFile<Other>& it, std::vector<Item>& block, std::vector<Other>& buffer)
+        {
+            buffer.resize (block.size());
+            size_t n = it.fill (buffer);
+            for (size_t i=0; i<n; i++)  {  block[i].value = buffer[i].value;  block[i].abundance = buffer[i].abundance;  }
+            return n;
+        }
+
+        IteratorFile<FileItem> _it;
+        std::vector<FileItem>  _buffer;
+    };
+
+    /** Constructor.
+     * \param[in] blockSize : number of items read at once from each source. */
+    CountMerger (size_t blockSize = 10000) : _blockSize(blockSize)  {}
+
+    /** Destructor. */
+    ~CountMerger ()  {  for (size_t i=0; i<_sources.size(); i++)  { delete _sources[i]; }  }
+
+    /** Add a source to be merged; the merger takes ownership of it.
+     * \param[in] source : the source. */
+    void addSource (Source* source)  {  _sources.push_back (source);  }
+
+    /** Add a file of items to be merged.
+     * \param[in] filename : name of the file. */
+    template <typename FileItem> void addFile (const std::string& filename)  {  addSource (new FileSource<FileItem> (filename));  }
+
+    /** Add a file of items to be merged.
+     * \param[in] filename : name of the file. */
+    void addFile (const std::string& filename)  {  addFile<Item> (filename);  }
+
+    /** Merge the sources; the functor is called for each distinct value, in increasing order,
+     * as f(value, abundance) where abundance is the sum of the abundances of this value.
+     * \param[in] f : functor called for each distinct value. */
+    template <typename Functor> void merge (Functor f)
+    {
+        size_t nb = _sources.size();
+
+        _blocks.assign (nb, std::vector<Item>());
+        _pos.assign  (nb, 0);
+        _size.assign (nb, 0);
+
+        LoserTree<Less> tree (nb, Less(*this));
+
+        for (size_t i=0; i<nb; i++)
+        {
+            _blocks[i].resize (_blockSize);
+            if (refill (i) == false)  {  tree.setDone (i);  }
+        }
+        tree.build ();
+
+        if (tree.isDone())  { return; }
+
+        Value     value     = current(tree.top()).value;
+        u_int64_t abundance = 0;
+
+        while (!tree.isDone())
+        {
+            size_t best = tree.top();
+            const Item& item = current (best);
+
+            if (item.value != value)
+            {
+                f (value, abundance);
+                value     = item.value;
+                abundance = 0;
+            }
+            abundance += item.abundance;
+
+            if (++_pos[best] == _size[best] && refill (best) == false)  {  tree.setDone (best);  }
+
+            tree.replay ();
+        }
+
+        f (value, abundance);
+    }
+
+private:
+
+    const Item& current (size_t i) const  {  return _blocks[i][_pos[i]];  }
+
+    bool refill (size_t i)
+    {
+        _blocks[i].resize (_blockSize);
+        _pos[i]  = 0;
+        _size[i] = _sources[i]->read (_blocks[i]);
+        return _size[i] > 0;
+    }
+
+    struct Less
+    {
+        Less (const CountMerger& ref) : _ref(ref) {}
+        bool operator() (size_t a, size_t b) const  {  return _ref.current(a).value < _ref.current(b).value;  }
+        const CountMerger& _ref;
+    };
+
+    size_t                          _blockSize;
+    std::vector<Source*>            _sources;
+    std::vector<std::vector<Item> > _blocks;
+    std::vector<size_t>             _pos;
+    std::vector<size_t>             _size;
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_COLLECTIONS_IMPL_KWAY_MERGE_HPP_ */
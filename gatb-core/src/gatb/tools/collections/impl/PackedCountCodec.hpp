@@ -0,0 +1,282 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file PackedCountCodec.hpp
+ *  \brief Compact encoding of sorted [kmer,abundance] items
+ */
+
+#ifndef _GATB_CORE_TOOLS_COLLECTIONS_IMPL_PACKED_COUNT_CODEC_HPP_
+#define _GATB_CORE_TOOLS_COLLECTIONS_IMPL_PACKED_COUNT_CODEC_HPP_
+
+/********************************************************************************/
+
+#include <gatb/tools/misc/api/Abundance.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include <cstring>
+#include <sys/types.h>
+
+/********************************************************************************/
+namespace gatb          {
+namespace core          {
+namespace tools         {
+namespace collections   {
+namespace impl          {
+/********************************************************************************/
+
+/** \brief Tells whether items of type Item can be stored with PackedCountCodec,
+ * ie. whether Item is a misc::Abundance (or derives from one, like Kmer<span>::Count).
+ */
+template <typename Item, typename Enable=void> struct IsPackedCount
+{
+    static const bool value = false;
+};
+
+/** \cond */
+template <typename T> struct PackedCountVoid { typedef void type; };
+
+template <typename Item> struct IsPackedCount<Item, typename PackedCountVoid<typename Item::NumberType>::type>
+{
+    static const bool value = std::is_base_of<misc::Abundance<typename Item::ValueType, typename Item::NumberType>, Item>::value;
+};
+/** \endcond */
+
+/********************************************************************************/
+
+/** \brief Encoding of [kmer,abundance] items sorted by kmer value.
+ *
+ * Items are encoded by blocks of at most BLOCK_SIZE items with non decreasing values:
+ *  - values are Elias-Fano coded: offsets to the first value of the block are split
+ *    into L low bits (stored as is) and high bits (stored in unary as gaps);
+ *    this takes about L+2 bits per kmer, with L = log2 (mean gap between kmers);
+ *  - abundances are stored as varints after the values.
+ *
+ * Unsorted input is supported (a new block is started when the value decreases), it is
+ * just less compact.
+ *
+ * Layout of a block:  [n] [body size] [L] [first value] [high bytes] [lows] [highs] [abundances]
+ * where n, body size, high bytes and abundances are varints. A file starts with MAGIC.
+ */
+template <typename Item> class PackedCountCodec
+{
+public:
+
+    typedef typename Item::ValueType  Value;
+    typedef typename Item::NumberType Number;
+
+    /** Maximum number of items in a block. */
+    static const size_t BLOCK_SIZE = 1024;
+
+    /** Size of the file header. */
+    static const size_t MAGIC_SIZE = 8;
+
+    /** File header of a packed count file. */
+    static const char* magic ()  { return "GATBPKC1"; }
+
+    /** Append the encoding of a block of items (sorted by value) to a buffer.
+     * \param[in] items : items to be encoded
+     * \param[in] n : number of items (<= BLOCK_SIZE)
+     * \param[out] out : buffer where the block is appended */
+    static void encode (const Item* items, size_t n, std::vector<u_int8_t>& out)
+    {
+        if (n == 0)  { return; }
+
+        Value first = items[0].value;
+        Value range = items[n-1].value - first;
+
+        /** Number of low bits: floor (log2 (range / n)). */
+        int L = 0;
+        Value q = range / (u_int32_t) n;
+        for (Value zero = zeroValue(); !(q == zero); q = q >> 1)  { L++; }
+        if (L > 0)  { L--; }
+
+        std::vector<u_int8_t> lows, highs;
+        BitWriter lowBits (lows), highBits (highs);
+
+        u_int64_t previousHigh = 0;
+        for (size_t i=0; i<n; i++)
+        {
+            Value offset = items[i].value - first;
+
+            for (int s=0; s<L; s+=64)  {  lowBits.write ((offset >> s).getVal(), std::min (64, L-s));  }
+
+            u_int64_t high = (offset >> L).getVal();
+            highBits.writeZeros (high - previousHigh);
+            highBits.write (1, 1);
+            previousHigh = high;
+        }
+        lowBits.flush();
+        highBits.flush();
+
+        std::vector<u_int8_t> body;
+        body.push_back (L);
+        body.insert (body.end(), (const u_int8_t*) &first, (const u_int8_t*) &first + sizeof(Value));
+        writeVarint (body, highs.size());
+        body.insert (body.end(), lows.begin(),  lows.end());
+        body.insert (body.end(), highs.begin(), highs.end());
+        for (size_t i=0; i<n; i++)  {  writeVarint (body, items[i].abundance);  }
+
+        writeVarint (out, n);
+        writeVarint (out, body.size());
+        out.insert (out.end(), body.begin(), body.end());
+    }
+
+    /** Decode the body of a block (ie. what follows the body size).
+     * \param[in] body : body of the block
+     * \param[in] n : number of items of the block
+     * \param[out] items : decoded items (resized to n) */
+    static void decode (const u_int8_t* body, size_t n, std::vector<Item>& items)
+    {
+        items.resize (n);
+
+        const u_int8_t* ptr = body;
+        int L = *ptr++;
+        Value first;  memcpy (&first, ptr, sizeof(Value));  ptr += sizeof(Value);
+        u_int64_t highSize = readVarint (ptr);
+
+        BitReader lowBits  (ptr);
+        BitReader highBits (ptr + (n*L + 7) / 8);
+
+        u_int64_t high = 0;
+        for (size_t i=0; i<n; i++)
+        {
+            Value offset = zeroValue();
+            for (int s=0; s<L; s+=64)
+            {
+                Value piece;  piece.setVal (lowBits.read (std::min (64, L-s)));
+                offset = offset | (piece << s);
+            }
+
+            high += highBits.readUnary();
+            Value h;  h.setVal (high);
+            offset = offset | (h << L);
+
+            items[i].value = first + offset;
+        }
+
+        ptr += (n*L + 7) / 8 + highSize;
+        for (size_t i=0; i<n; i++)  {  items[i].abundance = (Number) readVarint (ptr);  }
+    }
+
+    static void writeVarint (std::vector<u_int8_t>& out, u_int64_t value)
+    {
+        while (value >= 128)  {  out.push_back ((value & 127) | 128);  value >>= 7;  }
+        out.push_back (value);
+    }
+
+    static u_int64_t readVarint (const u_int8_t*& ptr)
+    {
+        u_int64_t value = 0;
+        for (int shift=0; ; shift+=7)
+        {
+            u_int8_t byte = *ptr++;
+            value |= (u_int64_t)(byte & 127) << shift;
+            if (byte < 128)  { return value; }
+        }
+    }
+
+private:
+
+    static Value zeroValue ()  {  Value zero;  zero.setVal(0);  return zero;  }
+
+    /** Bits are written LSB first. */
+    struct BitWriter
+    {
+        BitWriter (std::vector<u_int8_t>& out) : _out(out), _acc(0), _fill(0)  {}
+
+        void write (u_int64_t bits, int nb)
+        {
+            if (nb < 64)  { bits &= ((u_int64_t)1 << nb) - 1; }
+            while (nb > 0)
+            {
+                int take = std::min (nb, 64 - _fill);
+                _acc |= (take == 64 ? bits : bits & (((u_int64_t)1 << take) - 1)) << _fill;
+                _fill += take;
+                bits   = take == 64 ? 0 : bits >> take;
+                nb    -= take;
+                for ( ; _fill >= 8; _fill -= 8)  {  _out.push_back (_acc & 0xFF);  _acc >>= 8;  }
+            }
+        }
+
+        void writeZeros (u_int64_t nb)
+        {
+            for ( ; nb >= 64; nb -= 64)  { write (0, 64); }
+            write (0, nb);
+        }
+
+        void flush ()
+        {
+            for ( ; _fill > 0; _fill -= 8)  {  _out.push_back (_acc & 0xFF);  _acc >>= 8;  }
+            _acc = 0;  _fill = 0;
+        }
+
+        std::vector<u_int8_t>& _out;
+        u_int64_t _acc;
+        int       _fill;
+    };
+
+    struct BitReader
+    {
+        BitReader (const u_int8_t* data) : _data(data), _pos(0)  {}
+
+        u_int64_t read (int nb)
+        {
+            u_int64_t result = 0;
+            for (int got=0; got < nb; )
+            {
+                int off  = _pos & 7;
+                int take = std::min (8 - off, nb - got);
+                result |= (u_int64_t)((_data[_pos >> 3] >> off) & ((1 << take) - 1)) << got;
+                got  += take;
+                _pos += take;
+            }
+            return result;
+        }
+
+        /** Number of 0 bits before the next 1 bit (which is consumed). */
+        u_int64_t readUnary ()
+        {
+            u_int64_t zeros = 0;
+            while (true)
+            {
+                int off = _pos & 7;
+                u_int8_t byte = _data[_pos >> 3] >> off;
+                if (byte != 0)
+                {
+                    int tz = __builtin_ctz (byte);
+                    _pos += tz + 1;
+                    return zeros + tz;
+                }
+                zeros += 8 - off;
+                _pos  += 8 - off;
+            }
+        }
+
+        const u_int8_t* _data;
+        u_int64_t       _pos;
+    };
+};
+
+/********************************************************************************/
+} } } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_COLLECTIONS_IMPL_PACKED_COUNT_CODEC_HPP_ */
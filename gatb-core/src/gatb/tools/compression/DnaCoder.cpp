@@ -1291,6 +1291,14 @@ void QualDecoder::execute(){
 	
 	//printf("----Begin decomp of Block     ----\n");
 
+	if(_leon->_qualContextModel)
+	{
+		QualCoder qualCoder;
+		qualCoder.decode(_inbuffer, _blockSize, _buffer);
+		_finished = true;
+		return;
+	}
+
 	z_stream zs;
 	memset(&zs, 0, sizeof(zs));
 	
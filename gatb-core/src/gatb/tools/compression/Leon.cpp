@@ -37,6 +37,7 @@ const char* Leon::STR_TEST_DECOMPRESSED_FILE = "-test-file";
 const char* Leon::STR_DNA_ONLY = "-seq-only";
 const char* Leon::STR_NOHEADER = "-noheader";
 const char* Leon::STR_NOQUAL = "-noqual";
+const char* Leon::STR_QUAL_CODER = "-qual-coder";
 
 const char* Leon::STR_DATA_INFO = "Info";
 const char* Leon::STR_INIT_ITER = "-init-iterator";
@@ -86,6 +87,7 @@ _progress_decode(0),_generalModel(256),_inputBank(0),_anchorDictModel(5)
 	_compressed_qualSize = _anchorDictSize = _MCmultipleSolid = _anchorAdressSize = _readWithoutAnchorCount = _anchorPosSize = 0;
 	_input_qualSize = _total_nb_quals_smoothed = _otherSize =  _readSizeSize =  _bifurcationSize =  _noAnchorSize = 0;
 	_lossless = false;
+	_qualContextModel = false;
 	_storageH5file = 0;
 	_bloom = 0;
 	
@@ -127,6 +129,7 @@ _progress_decode(0),_generalModel(256),_inputBank(0),_anchorDictModel(5)
 
 	compressionParser->push_back (new OptionNoParam (Leon::STR_NOHEADER, "discard header", false));
 	compressionParser->push_back (new OptionNoParam (Leon::STR_NOQUAL, "discard quality scores", false));
+	compressionParser->push_back (new OptionOneParam (Leon::STR_QUAL_CODER, "quality scores coder: zlib, or cm (context model, better and faster)", false, "zlib"));
 
     IOptionsParser* decompressionParser = new OptionsParser ("decompression");
     decompressionParser->push_back (new OptionNoParam (Leon::STR_TEST_DECOMPRESSED_FILE, "check if decompressed file is the same as original file (both files must be in the same folder)", false));
@@ -139,9 +142,14 @@ _progress_decode(0),_generalModel(256),_inputBank(0),_anchorDictModel(5)
     getParser()->push_back (compressionParser);
     getParser()->push_back (decompressionParser, 0, false);
 
-	pthread_mutex_init(&findAndInsert_mutex, NULL);
+	for(int i=0; i<(1 << ANCHOR_SHARDS_BITS); i++){
+		_anchorShards[i].kmers = 0;
+		pthread_mutex_init(&_anchorShards[i].mutex, NULL);
+	}
 	pthread_mutex_init(&writeblock_mutex, NULL);
 	pthread_mutex_init(&minmax_mutex, NULL);
+	pthread_mutex_init(&decodeblock_mutex, NULL);
+	_decompressionSetupDone = false;
 
 	
 }
@@ -410,7 +418,19 @@ void Leon::executeCompression(){
           getInfo()->add (0, "Quality compression: LOSSLESS mode");
        else
           getInfo()->add (0, "Quality compression: lossy mode (use '-lossless' for lossless compression)");
-			
+
+			std::string qualCoder = getInput()->getStr (Leon::STR_QUAL_CODER);
+			if (qualCoder == "cm")
+			{
+				_qualContextModel = true;
+				infoByte |= 0x04; //qualities coded with QualCoder
+			}
+			else if (qualCoder != "zlib")
+			{
+				throw Exception ("unknown quality coder '%s' (use zlib or cm)", qualCoder.c_str());
+			}
+			getInfo()->add (0, "Quality coder", "%s", qualCoder.c_str());
+
 			_isFasta = false;
 			
 		}
@@ -580,7 +600,16 @@ void Leon::endQualCompression(){
 
 void Leon::writeBlockLena(u_int8_t* data, u_int64_t size, int encodedSequenceCount,u_int64_t blockID){
 
+	//qualities are compressed here, in the thread of the DnaEncoder that filled the block; only the write is serialized
+	std::string outstring;
 
+	if(_qualContextModel)
+	{
+		QualCoder qualCoder;
+		qualCoder.encode((const char*) data, size, outstring);
+	}
+	else
+	{
 	z_stream zs;
 	memset(&zs, 0, sizeof(zs));
 	
@@ -598,7 +627,6 @@ void Leon::writeBlockLena(u_int8_t* data, u_int64_t size, int encodedSequenceCou
 	
 	int ret;
 	char outbuffer[32768];
-	std::string outstring;
 	
 	// retrieve the compressed bytes blockwise
 	do {
@@ -615,6 +643,7 @@ void Leon::writeBlockLena(u_int8_t* data, u_int64_t size, int encodedSequenceCou
 	} while (ret == Z_OK);
 	
 	deflateEnd(&zs);
+	}
 	
 	/////////////////
 
@@ -917,7 +946,9 @@ void Leon::startDnaCompression(){
 
 //	_anchorKmers = new Hash16<kmer_type, u_int32_t > ( (nbestimated/10) *  sizeof(u_int32_t)  *10LL /1024LL / 1024LL ); // hmm  Hash16 would need a constructor with sizeof main entry //maybe *2 for low coverage dataset
 	u_int64_t nbcreated ;
-	_anchorKmers = new Hash16<kmer_type, u_int32_t > ( nbestimated/10 , &nbcreated ); //creator with nb entries given
+	for(int i=0; i<(1 << ANCHOR_SHARDS_BITS); i++){
+		_anchorShards[i].kmers = new Hash16<kmer_type, u_int32_t > ( std::max(nbestimated/10 >> ANCHOR_SHARDS_BITS, (int64_t)1024) , &nbcreated ); //creator with nb entries given
+	}
 //	printf("asked %lli entries, got %llu \n",nbestimated/10 ,nbcreated);
 	
     Iterator<Sequence>* itSeq = createIterator<Sequence> (
@@ -1015,7 +1046,10 @@ void Leon::endDnaCompression(){
 	getInfo()->add(2, "Error", "%.2f", ((_MCuniqNoSolid*100)/(double)_MCtotal));
 	
 
-	delete _anchorKmers;
+	for(int i=0; i<(1 << ANCHOR_SHARDS_BITS); i++){
+		delete _anchorShards[i].kmers;
+		_anchorShards[i].kmers = 0;
+	}
 	System::file().remove(_dskOutputFilename);
 
 
@@ -1033,6 +1067,19 @@ void Leon::writeBloom(){
 
 void Leon::writeAnchorDict(){
 
+	//anchors were inserted concurrently in the shards, encode them in adress order for the decoder
+	vector<kmer_type> anchors(_anchorAdress);
+	for(int i=0; i<(1 << ANCHOR_SHARDS_BITS); i++){
+		dp::Iterator< Hash16<kmer_type, u_int32_t >::cell >* it = _anchorShards[i].kmers->iterator();
+		LOCAL(it);
+		for(it->first(); !it->isDone(); it->next()){
+			anchors[it->item().val] = it->item().graine;
+		}
+	}
+	for(u_int32_t i=0; i<anchors.size(); i++){
+		encodeInsertedAnchor(anchors[i]);
+	}
+
 	_anchorRangeEncoder.flush();
 	
 	//todo check if the tempfile _dictAnchorFile may be avoided (with the use of hdf5 ?)
@@ -1082,12 +1129,13 @@ void Leon::writeAnchorDict(){
 
 bool Leon::anchorExist(const kmer_type& kmer, u_int32_t* anchorAdress){
 	
-	if (_anchorKmers->get(kmer,anchorAdress)) //avec Hash16
-	{
-		return true;
-	}
+	AnchorShard& shard = getAnchorShard(kmer);
+
+	pthread_mutex_lock(&shard.mutex);
+	bool found = shard.kmers->get(kmer,anchorAdress); //avec Hash16
+	pthread_mutex_unlock(&shard.mutex);
 
-	return false;
+	return found;
 
 }
 
@@ -1104,7 +1152,7 @@ void Leon::updateMinMaxSequenceSize(int newMin, int newMax)
 
 int Leon::findAndInsertAnchor(const vector<kmer_type>& kmers, u_int32_t* anchorAdress){
 	
-	pthread_mutex_lock(&findAndInsert_mutex);
+	//the search only reads the bloom, only the insertion is done under the lock of the anchor shard
 
 		
 	//cout << "\tSearching and insert anchor" << endl;
@@ -1214,20 +1262,20 @@ int Leon::findAndInsertAnchor(const vector<kmer_type>& kmers, u_int32_t* anchorA
 	
 	if(maxAbundance == -1)
 	{
-		pthread_mutex_unlock(&findAndInsert_mutex);
 		return -1;
 	}
 
-	encodeInsertedAnchor(bestKmer);
-	
-	_anchorKmers->insert(bestKmer,_anchorAdress); //with Hash16
-	//_anchorKmers[bestKmer] = _anchorAdress;
-	//_anchorKmers.insert(bestKmer, _anchorAdress);
-		
-	
-	*anchorAdress = _anchorAdress;
+	AnchorShard& shard = getAnchorShard(bestKmer);
+	pthread_mutex_lock(&shard.mutex);
+
+	//another thread may have inserted this anchor since findExistingAnchor, reuse it rather than adding a duplicate
+	if(! shard.kmers->get(bestKmer,anchorAdress)){
+		*anchorAdress = __sync_fetch_and_add(&_anchorAdress, 1);
+		shard.kmers->insert(bestKmer,*anchorAdress); //with Hash16
+		//_anchorKmers[bestKmer] = _anchorAdress;
+		//_anchorKmers.insert(bestKmer, _anchorAdress);
+	}
 	//_anchorKmerCount += 1;
-	_anchorAdress += 1;
 	
 	/*
 	int val;
@@ -1238,7 +1286,7 @@ int Leon::findAndInsertAnchor(const vector<kmer_type>& kmers, u_int32_t* anchorA
 		//_kmerAbundance->insert(kmerMin, val-1);
 	}*/
 
-	pthread_mutex_unlock(&findAndInsert_mutex);
+	pthread_mutex_unlock(&shard.mutex);
 	return bestPos;
 }
 
@@ -1389,8 +1437,10 @@ void Leon::executeDecompression(){
 	
 	//Second bit : option no header
 	//_noHeader = ((infoByte & 0x02) == 0x02);
-	
-	
+
+	//Third bit : qualities coded with QualCoder (-qual-coder cm) instead of zlib
+	_qualContextModel = ((infoByte & 0x04) == 0x04);
+
 	
 	std::string  filetype = _subgroupInfoCollection->getProperty("type");
 	if(filetype == "fasta")
@@ -1578,6 +1628,26 @@ void Leon::startDecompression_setup(){
 }
 
 
+void Leon::startDecompression_setup_once(){
+	pthread_mutex_lock(&decodeblock_mutex);
+	if(! _decompressionSetupDone)
+	{
+		startDecompression_setup();
+		_decompressionSetupDone = true;
+	}
+	pthread_mutex_unlock(&decodeblock_mutex);
+}
+
+u_int64_t Leon::getNbBlocks(){
+	startDecompression_setup_once();
+	return _dnaBlockSizes.size() / 2;
+}
+
+u_int64_t Leon::getNbSequencesInBlock(u_int64_t blockId){
+	startDecompression_setup_once();
+	return _dnaBlockSizes[2*blockId+1];
+}
+
 void Leon::decoders_setup(){
 
 
@@ -2323,7 +2393,7 @@ void Leon::LeonIterator::init()
 
 	///printf("iter init\n");
 
-	_leon.startDecompression_setup();
+	_leon.startDecompression_setup_once();
 	_leon.decoders_setup();
 	
 	
@@ -2337,6 +2407,121 @@ void Leon::LeonIterator::finalize()
 	
 }
 
+//////////////////////////////////////////////////
+//////////////// LeonBlockIterator ///////////////
+//////////////////////////////////////////////////
+
+Leon::LeonBlockIterator::LeonBlockIterator (Leon& refl, u_int64_t firstBlock, u_int64_t nbBlocks)
+: _leon(refl), _firstBlock(firstBlock), _endBlock(firstBlock), _currentBlock(firstBlock), _isDone(true),
+  _hdecoder(NULL), _qdecoder(NULL), _ddecoder(NULL), _posHeader(0), _posQual(0), _posDna(0), _remainingInBlock(0), _readid(0)
+{
+	u_int64_t nbTotal = _leon.getNbBlocks();
+	if(_firstBlock < nbTotal)
+		_endBlock = _firstBlock + std::min(nbBlocks, nbTotal - _firstBlock);
+	
+	pthread_mutex_lock(&_leon.decodeblock_mutex);
+	
+	_ddecoder = new DnaDecoder(&_leon, _leon._inputFilename, _leon._subgroupDNA);
+	if(! _leon._noHeader)
+		_hdecoder = new HeaderDecoder(&_leon, _leon._inputFilename, _leon._subgroupHeader);
+	if(! _leon._isFasta)
+		_qdecoder = new QualDecoder(&_leon, "qualities", _leon._subgroupQual);
+	
+	pthread_mutex_unlock(&_leon.decodeblock_mutex);
+}
+
+Leon::LeonBlockIterator::~LeonBlockIterator ()
+{
+	delete _ddecoder;
+	if(_hdecoder != NULL) delete _hdecoder;
+	if(_qdecoder != NULL) delete _qdecoder;
+}
+
+void Leon::LeonBlockIterator::first()
+{
+	//reads are numbered from the beginning of the archive when headers were not stored, as LeonIterator does
+	_readid = 0;
+	for(u_int64_t b=0; b<_firstBlock && b<_leon.getNbBlocks(); b++)
+		_readid += _leon.getNbSequencesInBlock(b);
+	
+	_currentBlock = _firstBlock;
+	_remainingInBlock = 0;
+	_isDone = false;
+	
+	next();
+}
+
+void Leon::LeonBlockIterator::next()
+{
+	while(_remainingInBlock == 0)
+	{
+		if(_currentBlock >= _endBlock)
+		{
+			_isDone = true;
+			return;
+		}
+		decodeBlock(_currentBlock++);
+	}
+	_remainingInBlock--;
+	
+	if(_hdecoder != NULL)
+		nextLine(_hdecoder->_buffer, _posHeader, _comment);
+	else
+		_comment = Stringify::format("%llu", (unsigned long long) _readid);
+	_readid++;
+	
+	nextLine(_ddecoder->_buffer, _posDna, _dna);
+	
+	if(_qdecoder != NULL)
+		nextLine(_qdecoder->_buffer, _posQual, _qual);
+	
+	_item->setComment(_comment);
+	_item->setQuality(_qual);
+	_item->getData().set(_dna.c_str(), _dna.size());
+}
+
+void Leon::LeonBlockIterator::decodeBlock(u_int64_t blockId)
+{
+	u_int64_t idx = 2*blockId;
+	
+	//setup opens the block datasets in groups shared by all the iterators: one at a time
+	pthread_mutex_lock(&_leon.decodeblock_mutex);
+	
+	if(_hdecoder != NULL)
+	{
+		_hdecoder->_buffer.clear();
+		_hdecoder->setup(0, _leon._headerBlockSizes[idx], _leon._headerBlockSizes[idx+1], blockId);
+	}
+	
+	_ddecoder->_buffer.clear();
+	_ddecoder->setup(0, _leon._dnaBlockSizes[idx], _leon._dnaBlockSizes[idx+1], blockId);
+	
+	if(_qdecoder != NULL)
+	{
+		_qdecoder->_buffer.clear();
+		_qdecoder->setup(blockId);
+	}
+	
+	pthread_mutex_unlock(&_leon.decodeblock_mutex);
+	
+	//the decoding itself is done by this thread only
+	if(_qdecoder != NULL) _qdecoder->execute();
+	if(_hdecoder != NULL) _hdecoder->execute();
+	_ddecoder->execute();
+	
+	_posHeader = _posQual = _posDna = 0;
+	_remainingInBlock = _leon._dnaBlockSizes[idx+1];
+}
+
+void Leon::LeonBlockIterator::nextLine(const std::string& buffer, size_t& pos, std::string& line)
+{
+	size_t end = buffer.find('\n', pos);
+	if(end == std::string::npos) end = buffer.size();
+	
+	line.assign(buffer, pos, end-pos);
+	pos = std::min(end+1, buffer.size());
+}
+
 //////////////////////////////////////////////////
 //////////////////// BankLeon ////////////////////
 //////////////////////////////////////////////////
@@ -57,6 +57,7 @@ typedef kmer::impl::Kmer<>::Count       kmer_count;
 #include <sstream>
 #include "HeaderCoder.hpp"
 #include "DnaCoder.hpp"
+#include "QualCoder.hpp"
 
 //#include "RangeCoder.hpp"
 
@@ -98,6 +99,7 @@ class Leon : public misc::impl::Tool
 		static const char* STR_DNA_ONLY;
 		static const char* STR_NOHEADER;
 		static const char* STR_NOQUAL;
+		static const char* STR_QUAL_CODER;
 		static const char* STR_INIT_ITER;
 
 	static const char* STR_DATA_INFO;
@@ -151,6 +153,7 @@ class Leon : public misc::impl::Tool
 		bool _noHeader;
 
 	bool _lossless;
+	bool _qualContextModel; //qualities blocks are coded with QualCoder instead of zlib
 	//for qual compression
 		u_int64_t _total_nb_quals_smoothed ;
 		u_int64_t _input_qualSize;
@@ -213,6 +216,10 @@ class Leon : public misc::impl::Tool
 			return _read_per_block;
 		}
 
+		//block index of an archive opened for decompression
+		u_int64_t getNbBlocks();
+		u_int64_t getNbSequencesInBlock(u_int64_t blockId);
+
 	private:
 
     int _read_per_block;
@@ -317,14 +324,22 @@ class Leon : public misc::impl::Tool
 		
 		//map<kmer_type, u_int32_t> _anchorKmers; //uses 46 B per elem inserted
 		//OAHash<kmer_type> _anchorKmers;
-		Hash16<kmer_type, u_int32_t >  * _anchorKmers ; //will  use approx 20B per elem inserted
+		//anchor dict is sharded by kmer hash, so that DnaEncoder threads only wait for each other when they use the same shard
+		//adresses come from the shared counter _anchorAdress, the dict is encoded in adress order once all reads are done
+		static const int ANCHOR_SHARDS_BITS = 6;
+		struct AnchorShard
+		{
+			Hash16<kmer_type, u_int32_t >  * kmers ; //will  use approx 20B per elem inserted
+			pthread_mutex_t mutex;
+		};
+		AnchorShard _anchorShards[1 << ANCHOR_SHARDS_BITS];
+		AnchorShard& getAnchorShard(const kmer_type& kmer) { return _anchorShards[hash1(kmer,0) >> (64 - ANCHOR_SHARDS_BITS)]; }
 
 		//Header decompression
 	
 		string _headerOutputFilename;
 	
 	  // 	int _auto_cutoff;
-		pthread_mutex_t findAndInsert_mutex;
 		pthread_mutex_t writeblock_mutex;
 		pthread_mutex_t minmax_mutex;
 
@@ -343,6 +358,9 @@ class Leon : public misc::impl::Tool
 		//IFile* _outputFile;
 	
 	void startDecompression_setup();
+	bool _decompressionSetupDone;
+	void startDecompression_setup_once(); //thread safe version, for the block iterators
+	pthread_mutex_t decodeblock_mutex;
 	void decoders_setup();
 	void decoders_cleanup();
 
@@ -422,6 +440,54 @@ class Leon : public misc::impl::Tool
 		u_int64_t _readid;
 
 	};
+	
+	//iterates the sequences of blocks [firstBlock, firstBlock+nbBlocks), decoding them in the calling thread with its own decoders:
+	//several instances can be used at the same time on disjoint block ranges (one per dispatcher thread for instance)
+	class LeonBlockIterator : public tools::dp::Iterator<Sequence>
+	{
+	public:
+		
+		LeonBlockIterator (Leon& ref, u_int64_t firstBlock, u_int64_t nbBlocks);
+		
+		/** Destructor */
+		~LeonBlockIterator ();
+		
+		/** \copydoc tools::dp::Iterator::first */
+		void first();
+		
+		/** \copydoc tools::dp::Iterator::next */
+		void next();
+		
+		/** \copydoc tools::dp::Iterator::isDone */
+		bool isDone ()  { return _isDone; }
+		
+		/** \copydoc tools::dp::Iterator::item */
+		Sequence& item ()     { return *_item; }
+		
+	private:
+		
+		Leon&    _leon;
+		
+		u_int64_t _firstBlock;
+		u_int64_t _endBlock;
+		u_int64_t _currentBlock;
+		bool _isDone;
+		
+		HeaderDecoder* _hdecoder ;
+		QualDecoder* _qdecoder;
+		DnaDecoder* _ddecoder ;
+		
+		//position of the next line in the decoded buffers
+		size_t _posHeader;
+		size_t _posQual;
+		size_t _posDna;
+		u_int64_t _remainingInBlock;
+		u_int64_t _readid;
+		std::string _comment, _dna, _qual;
+		
+		void decodeBlock(u_int64_t blockId);
+		static void nextLine(const std::string& buffer, size_t& pos, std::string& line);
+	};
 };
 
 
@@ -446,6 +512,19 @@ public:
 	/** \copydoc IBank::iterator */
 	tools::dp::Iterator<Sequence>* iterator ()  { return new Leon::LeonIterator (*_leon); }
 	
+	/** Iterator over the sequences of some blocks of the archive. Iterators over disjoint block ranges
+	 * can be used concurrently, each one decoding its blocks in the thread that uses it.
+	 * \param[in] firstBlock : first block to iterate
+	 * \param[in] nbBlocks : number of blocks to iterate
+	 * \return the iterator */
+	tools::dp::Iterator<Sequence>* iterator (u_int64_t firstBlock, u_int64_t nbBlocks)  { return new Leon::LeonBlockIterator (*_leon, firstBlock, nbBlocks); }
+	
+	/** \return number of blocks of the archive (read from its index). */
+	u_int64_t getNbBlocks ()  { return _leon->getNbBlocks(); }
+	
+	/** \return exact number of sequences of a block (read from the archive index). */
+	u_int64_t getNbSequencesInBlock (u_int64_t blockId)  { return _leon->getNbSequencesInBlock(blockId); }
+	
 	/** */
 	int64_t getNbItems () ;
 	
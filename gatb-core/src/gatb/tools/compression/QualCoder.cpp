@@ -0,0 +1,147 @@
+/*****************************************************************************
+ *   Leon: reference free compression for NGS reads
+ *   A tool from the GATB (Genome Assembly Tool Box)
+ *   Copyright (C) 2014  INRIA
+ *   Authors: G.Benoit, G.Rizk, C.Lemaitre
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#include "QualCoder.hpp"
+
+#include <sstream>
+
+//====================================================================================
+// ** QualCoder
+//====================================================================================
+QualCoder::QualCoder() : _nbSymbols(0)
+{
+}
+
+QualCoder::~QualCoder(){
+	clear();
+}
+
+void QualCoder::clear(){
+	for(unsigned int i=0; i<_models.size(); i++){
+		delete _models[i];
+	}
+	_models.clear();
+}
+
+void QualCoder::setup(int nbSymbols){
+	clear();
+	_nbSymbols = nbSymbols;
+	_models.assign((CONTEXT_SYMBOLS+1) * (CONTEXT_SYMBOLS+1) * POSITION_BUCKETS, NULL);
+}
+
+Order0Model& QualCoder::model(int prev1, int prev2, u_int64_t pos){
+	int bucket = std::min(pos >> POSITION_SHIFT, (u_int64_t) POSITION_BUCKETS-1);
+	int ctx = (contextSymbol(prev1) * (CONTEXT_SYMBOLS+1) + contextSymbol(prev2)) * POSITION_BUCKETS + bucket;
+
+	if(_models[ctx] == NULL){
+		_models[ctx] = new Order0Model(_nbSymbols);
+	}
+	return *_models[ctx];
+}
+
+void QualCoder::encode(const char* quals, u_int64_t size, string& out){
+
+	//alphabet of the block, '\n' always belongs to it
+	bool used[256] = {false};
+	used[(u_int8_t)'\n'] = true;
+	for(u_int64_t i=0; i<size; i++){
+		used[(u_int8_t)quals[i]] = true;
+	}
+
+	u_int8_t symbolOf[256];
+	string alphabet;
+	for(int c=0; c<256; c++){
+		if(used[c]){
+			symbolOf[c] = alphabet.size();
+			alphabet += (char) c;
+		}
+	}
+
+	setup(alphabet.size());
+
+	out.clear();
+	for(int i=0; i<8; i++){
+		out += (char) ((size >> (i*8)) & 0xff);
+	}
+	out += (char) (alphabet.size() - 1);
+	out += alphabet;
+
+	RangeEncoder rangeEncoder;
+
+	int prev1 = START_SYMBOL, prev2 = START_SYMBOL;
+	u_int64_t pos = 0;
+	for(u_int64_t i=0; i<size; i++){
+		u_int8_t c = symbolOf[(u_int8_t)quals[i]];
+		rangeEncoder.encode(model(prev1, prev2, pos), c);
+
+		if(quals[i] == '\n'){
+			prev1 = prev2 = START_SYMBOL;
+			pos = 0;
+		}
+		else{
+			prev2 = prev1;
+			prev1 = c;
+			pos++;
+		}
+	}
+	rangeEncoder.flush();
+
+	out.append((const char*) rangeEncoder.getBuffer(), rangeEncoder.getBufferSize());
+
+	clear();
+}
+
+void QualCoder::decode(const char* data, u_int64_t size, string& out){
+
+	u_int64_t rawSize = 0;
+	for(int i=0; i<8; i++){
+		rawSize |= ((u_int64_t)(u_int8_t) data[i]) << (i*8);
+	}
+	int nbSymbols = (u_int8_t) data[8] + 1;
+	const char* alphabet = data + 9;
+	u_int64_t headerSize = 9 + nbSymbols;
+
+	setup(nbSymbols);
+
+	std::istringstream stream(string(data + headerSize, size - headerSize));
+	RangeDecoder rangeDecoder;
+	rangeDecoder.setInputFile(&stream);
+
+	out.resize(rawSize);
+
+	int prev1 = START_SYMBOL, prev2 = START_SYMBOL;
+	u_int64_t pos = 0;
+	for(u_int64_t i=0; i<rawSize; i++){
+		u_int8_t c = rangeDecoder.nextByte(model(prev1, prev2, pos));
+		out[i] = alphabet[c];
+
+		if(alphabet[c] == '\n'){
+			prev1 = prev2 = START_SYMBOL;
+			pos = 0;
+		}
+		else{
+			prev2 = prev1;
+			prev1 = c;
+			pos++;
+		}
+	}
+
+	clear();
+}
@@ -0,0 +1,67 @@
+/*****************************************************************************
+ *   Leon: reference free compression for NGS reads
+ *   A tool from the GATB (Genome Assembly Tool Box)
+ *   Copyright (C) 2014  INRIA
+ *   Authors: G.Benoit, G.Rizk, C.Lemaitre
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+
+#ifndef _QUALCODER_HPP_
+#define _QUALCODER_HPP_
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <sys/types.h>
+
+#include "RangeCoder.hpp"
+
+using namespace std;
+
+//====================================================================================
+// ** QualCoder
+//====================================================================================
+//Context-model coder for a block of qualities (one line per read, each ending with '\n'),
+//used instead of zlib with leon option -qual-coder cm.
+//Each quality is range coded with an adaptive model chosen from the two previous qualities
+//of the read (order 2) and the position in the read.
+//
+//Encoded block: raw size (8 bytes), alphabet size - 1 (1 byte), alphabet (sorted bytes), range coded symbols.
+class QualCoder
+{
+	public:
+		QualCoder();
+		~QualCoder();
+
+		void encode(const char* quals, u_int64_t size, string& out);
+		void decode(const char* data, u_int64_t size, string& out);
+
+	private:
+		//qualities above the 63th of the alphabet share their context (they are rare)
+		static const int CONTEXT_SYMBOLS = 64;
+		static const int START_SYMBOL = 256; //previous quality of the first qualities of a read
+		static const int POSITION_SHIFT = 4;
+		static const int POSITION_BUCKETS = 8;
+
+		vector<Order0Model*> _models; //allocated when the context is first seen
+		int _nbSymbols;
+
+		void setup(int nbSymbols);
+		void clear();
+		Order0Model& model(int prev1, int prev2, u_int64_t pos);
+		static int contextSymbol(int prev) { return prev == START_SYMBOL ? CONTEXT_SYMBOLS : std::min(prev, CONTEXT_SYMBOLS-1); }
+};
+
+#endif /* _QUALCODER_HPP_ */
@@ -28,52 +28,127 @@
 //====================================================================================
 Order0Model::Order0Model(int charCount){
 	_charCount = charCount+1;
+	_small = charCount <= SMALL_ALPHABET;
 	
-	for(int i=0; i<_charCount; i++){
-		_charRanges.push_back(i);
-	}
+	_topStep = 1;
+	while(_topStep*2 <= charCount) _topStep *= 2;
+	
+	clear();
 }
 
 Order0Model::~Order0Model(){
 }
 
 void Order0Model::clear(){
-	for(int i=0; i<_charCount; i++){
-		_charRanges[i] = i;
-	}
+	_freqs.assign(_charCount-1, 1);
+	buildTree();
+}
+
+void Order0Model::buildTree(){
+	int n = _freqs.size();
 	
+	_tree.assign(n+1, 0);
+	_total = 0;
+	for(int i=1; i<=n; i++){
+		_total += _freqs[i-1];
+		if(_small){
+			_tree[i] = _total;
+		}
+		else{
+			_tree[i] += _freqs[i-1];
+			int j = i + (i & -i);
+			if(j <= n) _tree[j] += _tree[i];
+		}
+	}
 }
 
 void Order0Model::update(uint8_t c){
-	//cout << rangeLow(c) <<  " " << rangeHigh(c) << " " << totalRange()<< endl;
-	for(int i=c+1; i<_charCount; i++){
-		_charRanges[i] += 1;
+	_freqs[c] += 1;
+	if(_small){
+		for(int i=c+1; i<_charCount; i++){
+			_tree[i] += 1;
+		}
+	}
+	else{
+		for(int i=c+1; i<_charCount; i += i & -i){
+			_tree[i] += 1;
+		}
 	}
-	if(_charRanges[_charCount-1] >= MAX_RANGE){
+	_total += 1;
+	
+	if(_total >= MAX_RANGE){
 		rescale();
 	}
 }
 
+//halve the cumulative ranges, keeping each symbol at least one (same rounding as before the Fenwick tree)
 void Order0Model::rescale(){
-	for(int i=1; i<_charCount; i++) {
-		_charRanges[i] /= 2;
-		if(_charRanges[i] <= _charRanges[i-1]){
-			_charRanges[i] = _charRanges[i-1] + 1;
-		}
+	u_int64_t prev = 0, cur = 0;
+	for(unsigned int i=0; i<_freqs.size(); i++) {
+		cur += _freqs[i];
+		u_int64_t rescaled = std::max(cur / 2, prev + 1);
+		_freqs[i] = rescaled - prev;
+		prev = rescaled;
+	}
+	buildTree();
+}
+
+u_int64_t Order0Model::prefix(int c){
+	if(_small) return _tree[c];
+	
+	u_int64_t sum = 0;
+	for(int i=c; i>0; i -= i & -i){
+		sum += _tree[i];
 	}
+	return sum;
 }
 
 u_int64_t Order0Model::rangeLow(uint8_t c){
-	return _charRanges[c];
+	return prefix(c);
 }
 
 u_int64_t Order0Model::rangeHigh(uint8_t c){
-	return _charRanges[c+1];
+	return prefix(c) + _freqs[c];
+}
+
+void Order0Model::getRange(uint8_t c, u_int64_t& low, u_int64_t& high){
+	low = prefix(c);
+	high = low + _freqs[c];
+}
+
+uint8_t Order0Model::findSymbol(u_int64_t count, u_int64_t& low, u_int64_t& high){
+	int n = _freqs.size();
+	int pos = 0;
+	
+	if(_small){
+		for(pos=n-1; pos>0 && _tree[pos] > count; pos--);
+		low = _tree[pos];
+		high = _tree[pos+1];
+		return pos;
+	}
+	
+	//descend the tree: pos is the number of symbols whose cumulated frequency is <= count
+	u_int64_t rem = count;
+	for(int step=_topStep; step>0; step >>= 1){
+		if(pos+step <= n && _tree[pos+step] <= rem){
+			pos += step;
+			rem -= _tree[pos];
+		}
+	}
+	
+	//count beyond the total range (corrupted input): last symbol, as the former linear search did
+	if(pos >= n){
+		pos = n-1;
+		rem = count - prefix(pos);
+	}
+	
+	low = count - rem;
+	high = low + _freqs[pos];
+	return pos;
 }
 
 u_int64_t Order0Model::totalRange(){
-	return _charRanges[_charRanges.size()-1];
-	//return _charRanges[_charCount-1];
+	return _total;
 }
 
 unsigned int Order0Model::charCount(){
@@ -108,10 +183,13 @@ void RangeEncoder::encode(Order0Model& model, uint8_t c){
 		printf("\t\t\tencoding char: %c\n", c);
 	#endif
 	
+	u_int64_t low, high;
+	model.getRange(c, low, high);
+	
 	//cout << model->rangeHigh(c) -model->rangeLow(c) << endl;
 	_range /= model.totalRange();
-	_low += model.rangeLow(c) * _range;
-	_range *= model.rangeHigh(c) - model.rangeLow(c);
+	_low += low * _range;
+	_range *= high - low;
 
 	while((_low ^ (_low + _range)) < TOP || _range < BOTTOM){
 		if(_range < BOTTOM && (_low ^ (_low+_range)) >= TOP){
@@ -196,10 +274,10 @@ void RangeDecoder::setInputFile(istream* inputFile, bool reversed){
 
 uint8_t RangeDecoder::nextByte(Order0Model& model){
 	u_int64_t count = getCurrentCount(model);
-	uint8_t c;
-	for(c=model.charCount()-2; model.rangeLow(c) > count; c--);
+	u_int64_t low, high;
+	uint8_t c = model.findSymbol(count, low, high);
 
-	removeRange(model, c);
+	removeRange(low, high);
 
 	model.update(c);
 	//cout << "RangeDecoder output: " << (int)c << endl;
@@ -211,9 +289,9 @@ u_int64_t RangeDecoder::getCurrentCount(Order0Model& model){
 	return (_code-_low) / _range;
 }
 
-void RangeDecoder::removeRange(Order0Model& model, uint8_t c){
-	_low += model.rangeLow(c) * _range;
-	_range *= model.rangeHigh(c) - model.rangeLow(c);
+void RangeDecoder::removeRange(u_int64_t low, u_int64_t high){
+	_low += low * _range;
+	_range *= high - low;
 
 	while((_low ^ (_low + _range)) < TOP || _range < BOTTOM ){
 		if(_range < BOTTOM && (_low ^ (_low + _range)) >= TOP){
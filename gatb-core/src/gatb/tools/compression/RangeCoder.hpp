@@ -40,9 +40,15 @@ const u_int64_t MAX_RANGE = BOTTOM;
 
 
 
+//Adaptive frequency model. Symbol frequencies are kept in a Fenwick tree, so that getting the range
+//of a symbol, finding the symbol of a count and updating a frequency are O(log(alphabet size)).
+//Small alphabets (read types, nucleotides) keep a plain cumulative table, faster at that size.
+//Ranges are exactly the ones of the former cumulative table (same file format).
 class Order0Model
 {
 	
+	static const int SMALL_ALPHABET = 16;
+	
 	public:
 		Order0Model(int charCount);
 		~Order0Model();
@@ -54,11 +60,22 @@ class Order0Model
 		u_int64_t rangeHigh(uint8_t c);
 		u_int64_t totalRange();
 		unsigned int charCount();
+
+		//rangeLow and rangeHigh of c
+		void getRange(uint8_t c, u_int64_t& low, u_int64_t& high);
+		//the symbol whose range contains count, and its range
+		uint8_t findSymbol(u_int64_t count, u_int64_t& low, u_int64_t& high);
 	
 	private:
-		vector<u_int64_t> _charRanges;
-		int _charCount;
+		vector<u_int64_t> _freqs;
+		vector<u_int64_t> _tree; //1-based, _tree[i] is the sum of the frequencies of symbols [i-(i&-i), i) (or [0, i) for a small alphabet)
+		u_int64_t _total;
+		bool _small;
+		int _charCount; //alphabet size + 1
+		int _topStep; //highest power of 2 <= alphabet size
 		
+		u_int64_t prefix(int c);
+		void buildTree();
 		void rescale();
 		
 };
@@ -125,7 +142,7 @@ class RangeDecoder : AbstractRangeCoder
 		bool _reversed;
 		
 		u_int64_t getCurrentCount(Order0Model& model);
-		void removeRange(Order0Model& model, uint8_t c);
+		void removeRange(u_int64_t low, u_int64_t high);
 		u_int8_t getNextByte();
 };
 
@@ -21,6 +21,9 @@
 #include <gatb/system/impl/System.hpp>
 #include <gatb/tools/misc/impl/TimeInfo.hpp>
 
+#include <mutex>
+#include <condition_variable>
+
 using namespace std;
 using namespace gatb::core::tools::dp;
 using namespace gatb::core::system;
@@ -33,31 +36,219 @@ namespace dp    {
 namespace impl  {
 /********************************************************************************/
 
-/** */
-class CommandStartSynchro : public ICommand, public system::SmartPointer
+/** Pool of persistent threads shared by the Dispatcher instances.
+ *
+ * Each command of a dispatch gets its own idle thread, as when the threads were created at
+ * each dispatch: commands may wait for each other, and code like ThreadObject or
+ * ThreadGroup::findThreadInfo relies on one thread per command. So the threads of a dispatch
+ * are registered as a ThreadGroup while the commands run, and new threads are created when
+ * no idle one is available.
+ *
+ * On NUMA machines, the threads are grouped by node and the command i of N runs on the node
+ * i*nbNodes/N. The idle threads are reused in LIFO order, so that a dispatch gets the threads
+ * (and the caches) used most recently.
+ *
+ * The pool is never destroyed: its threads wait for commands until the end of the process.
+ */
+class WorkerPool
 {
 public:
 
-    CommandStartSynchro (ICommand* ref, system::ISynchronizer* synchro) : _ref(0), _synchro(synchro)  { setRef(ref); }
-    ~CommandStartSynchro ()  { setRef(0); }
+    static WorkerPool& singleton ()  {  static WorkerPool* instance = new WorkerPool ();  return *instance;  }
 
-    void execute ()
+    /** Run the commands, each one in its own thread, and wait for them.
+     * \return the exceptions thrown by the commands. */
+    std::vector<system::Exception> run (std::vector<ICommand*>& commands)
     {
-        if (_ref && _synchro)
+        size_t nbTasks = commands.size();
+
+        Batch batch (nbTasks);
+        if (nbTasks == 0)  { return batch.exceptions; }
+
+        /** We take idle threads on the nodes of the commands. */
+        std::vector<Worker*>          workers (nbTasks);
+        std::vector<system::IThread*> threads (nbTasks);
+        {
+            std::unique_lock<std::mutex> lock (_mutex);
+            for (size_t i=0; i<nbTasks; i++)
+            {
+                size_t node = i * _nbNodes / nbTasks;
+                if (_idle[node].empty())  {  newWorker (node);  }
+
+                workers[i] = _idle[node].back();
+                _idle[node].pop_back();
+                threads[i] = workers[i]->thread;
+            }
+        }
+
+        system::IThreadGroup* group = system::impl::ThreadGroup::create (threads);
+
         {
-            /** We lock/unlock the synchronizer. */
-            _synchro->lock();  _synchro->unlock ();
+            std::unique_lock<std::mutex> lock (_mutex);
+            for (size_t i=0; i<nbTasks; i++)
+            {
+                workers[i]->task    = commands[i];
+                workers[i]->batch   = &batch;
+                workers[i]->hasTask = true;
+                workers[i]->wakeup.notify_one();
+            }
+        }
 
-            /** We execute the delegate command. */
-            _ref->execute();
+        /** We wait for the end of the commands. */
+        {
+            std::unique_lock<std::mutex> lock (batch.mutex);
+            batch.done.wait (lock, [&batch] { return batch.remaining == 0; });
         }
+
+        /** The threads are given back only once they left the group. */
+        system::impl::ThreadGroup::destroy (group);
+        {
+            std::unique_lock<std::mutex> lock (_mutex);
+            for (size_t i=0; i<nbTasks; i++)  {  _idle[workers[i]->node].push_back (workers[i]);  }
+        }
+
+        return batch.exceptions;
+    }
+
+    void setAffinity (Dispatcher::Affinity affinity)
+    {
+        std::unique_lock<std::mutex> lock (_mutex);
+        _affinity = affinity;
+        _affinityVersion ++;
     }
 
 private:
-    ICommand* _ref;
-    void setRef (ICommand* ref)  { SP_SETATTR(ref); }
 
-    system::ISynchronizer* _synchro;
+    struct Batch
+    {
+        Batch (size_t n) : remaining(n)  {}
+        std::mutex                     mutex;
+        std::condition_variable        done;
+        size_t                         remaining;
+        std::vector<system::Exception> exceptions;
+    };
+
+    struct Worker
+    {
+        Worker (WorkerPool* pool, size_t node, size_t rank)
+            : pool(pool), thread(0), node(node), rank(rank), affinityVersion(0), bound(false), task(0), batch(0), hasTask(false)  {}
+
+        WorkerPool*             pool;
+        system::IThread*        thread;
+        size_t                  node;
+        size_t                  rank;   // rank of the thread in its node
+        size_t                  affinityVersion;
+        bool                    bound;
+        std::condition_variable wakeup;
+        ICommand*               task;
+        Batch*                  batch;
+        bool                    hasTask;
+    };
+
+    WorkerPool () : _nbNodes(system::impl::System::info().getNbNumaNodes()), _affinity(Dispatcher::AFFINITY_NUMA), _affinityVersion(1)
+    {
+        if (_nbNodes == 0)  { _nbNodes = 1; }
+        _idle.resize  (_nbNodes);
+        _ranks.assign (_nbNodes, 0);
+    }
+
+    /** Must be called with _mutex locked. */
+    void newWorker (size_t node)
+    {
+        Worker* worker = new Worker (this, node, _ranks[node]++);
+        worker->thread = system::impl::System::thread().newThread (mainloop, worker);
+        _idle[node].push_back (worker);
+    }
+
+    /** Bind the worker according to the current affinity, if it changed since its last command. */
+    void applyAffinity (Worker* worker)
+    {
+        Dispatcher::Affinity affinity;
+        size_t               version;
+        {
+            std::unique_lock<std::mutex> lock (_mutex);
+            affinity = _affinity;
+            version  = _affinityVersion;
+        }
+        if (worker->affinityVersion == version)  { return; }
+        worker->affinityVersion = version;
+
+        std::vector<size_t> cores = system::impl::System::info().getNumaNodeCores (worker->node);
+
+        if (affinity == Dispatcher::AFFINITY_CORES && cores.empty()==false)
+        {
+            worker->bound = system::impl::System::thread().setAffinity (std::vector<size_t> (1, cores[worker->rank % cores.size()]));
+        }
+        else if (affinity == Dispatcher::AFFINITY_NUMA && _nbNodes > 1)
+        {
+            worker->bound = system::impl::System::thread().setAffinity (cores);
+        }
+        else if (worker->bound)
+        {
+            std::vector<size_t> all;
+            for (size_t n=0; n<_nbNodes; n++)
+            {
+                std::vector<size_t> c = system::impl::System::info().getNumaNodeCores (n);
+                all.insert (all.end(), c.begin(), c.end());
+            }
+            system::impl::System::thread().setAffinity (all);
+            worker->bound = false;
+        }
+    }
+
+    static void* mainloop (void* data)
+    {
+        Worker*     worker = (Worker*) data;
+        WorkerPool* pool   = worker->pool;
+
+        while (true)
+        {
+            ICommand* cmd   = 0;
+            Batch*    batch = 0;
+            {
+                std::unique_lock<std::mutex> lock (pool->_mutex);
+                worker->wakeup.wait (lock, [worker] { return worker->hasTask; });
+                cmd   = worker->task;
+                batch = worker->batch;
+                worker->hasTask = false;
+            }
+
+            pool->applyAffinity (worker);
+
+            /** Here, we should catch any exception thrown locally in a thread
+             * and keep it to re-throw it in the calling thread. */
+            system::Exception exception;
+            bool              hasException = false;
+            if (cmd != 0)
+            {
+                try
+                {
+                    cmd->use ();
+                    cmd->execute();
+                    cmd->forget ();
+                }
+                catch (system::Exception& e)
+                {
+                    exception    = e;
+                    hasException = true;
+                }
+            }
+
+            /** The batch belongs to the calling thread: it must not be used once it is notified. */
+            std::unique_lock<std::mutex> lock (batch->mutex);
+            if (hasException)  {  batch->exceptions.push_back (exception);  }
+            if (--batch->remaining == 0)  {  batch->done.notify_all();  }
+        }
+
+        return 0;
+    }
+
+    size_t                              _nbNodes;
+    std::mutex                          _mutex;
+    std::vector<std::vector<Worker*> >  _idle;
+    std::vector<size_t>                 _ranks;
+    Dispatcher::Affinity                _affinity;
+    size_t                              _affinityVersion;
 };
 
 /********************************************************************************/
@@ -131,34 +322,11 @@ size_t Dispatcher::dispatchCommands (std::vector<ICommand*>& commands, ICommand*
 {
     TIME_START (ti, "compute");
 
-    system::IThreadGroup* threadGroup = system::impl::ThreadGroup::create ();
-
-    size_t idx = 0;
-
-    /** We create threads and add them to the thread group. */
-    for (std::vector<ICommand*>::iterator it = commands.begin(); it != commands.end(); it++, idx++)
-    {
-        /** We add the thread to the group. Note that we have to set two things:
-         *  - the main loop function to be called by the thread
-         *  - the information to be provided to the main loop.
-         *
-         *  Note that we provide here a IThreadGroup::Info instance as data for the main loop
-         *  => it is important that at the beginning of the main loop we retrieved the correct
-         *  type from the void* data. */
-        threadGroup->add (
-            mainloop,
-            new IThreadGroup::Info (threadGroup,  new CommandStartSynchro (*it, threadGroup->getSynchro()), idx )
-        );
-    }
-
-    /** We start the group. */
-    threadGroup->start ();
+    /** We run the commands through the threads of the pool. */
+    std::vector<system::Exception> exceptions = WorkerPool::singleton().run (commands);
 
     /** We may have to forward exceptions got in threads. */
-    if (threadGroup->hasExceptions())  { throw threadGroup->getException(); }
-
-    /** Some cleanup. */
-    system::impl::ThreadGroup::destroy (threadGroup);
+    if (exceptions.empty() == false)  { throw exceptions[0]; }
 
     TIME_STOP (ti, "compute");
 
@@ -187,45 +355,9 @@ system::ISynchronizer* Dispatcher::newSynchro ()
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-system::IThread* Dispatcher::newThread (ICommand* command)
-{
-    return system::impl::System::thread().newThread (mainloop, command);
-}
-
-/*********************************************************************
-** METHOD  :
-** PURPOSE :
-** INPUT   :
-** OUTPUT  :
-** RETURN  :
-** REMARKS :
-*********************************************************************/
-void* Dispatcher::mainloop (void* data)
+void Dispatcher::setAffinity (Affinity affinity)
 {
-    IThreadGroup::Info* info = (IThreadGroup::Info*) data;
-    LOCAL (info);
-
-    IThreadGroup* threadGroup = info->group;
-    ICommand*    cmd          = (ICommand*) info->data;
-
-    assert (threadGroup != 0);
-    assert (cmd         != 0);
-
-    /** Here, we should catch any exception thrown locally in a thread
-     * and keep it to re-throw it in the main thread. */
-    try
-    {
-        cmd->use ();
-        cmd->execute();
-        cmd->forget ();
-    }
-    catch (system::Exception& e)
-    {
-    	/** We copy the exception in the list of received exceptions of the thread group. */
-        threadGroup->addException (e);
-    }
-
-    return 0;
+    WorkerPool::singleton().setAffinity (affinity);
 }
 
 /********************************************************************************/
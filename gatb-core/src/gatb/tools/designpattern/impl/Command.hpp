@@ -91,6 +91,12 @@ private:
  *  Dispatcher, it retrieves the number of available cores through the
  *  a call to system functions, and uses it as default value. This means
  *  that default constructor will use by default the whole CPU multicore power.
+ *
+ *  The threads are not created at each dispatch: all the Dispatcher instances share a pool
+ *  of persistent threads. Each command of a dispatch still gets its own thread (the pool grows
+ *  when needed), so commands may wait for each other. On NUMA machines, the threads are
+ *  grouped by node and the commands of a dispatch are spread over the nodes by blocks:
+ *  the command i of N runs on the node i*nbNodes/N.
  */
 class Dispatcher : public IDispatcher
 {
@@ -102,6 +108,22 @@ public:
      */
     Dispatcher (size_t nbUnits=0, size_t groupSize=0);
 
+    /** Placement of the threads on the cores. */
+    enum Affinity
+    {
+        /** the threads are placed by the operating system */
+        AFFINITY_NONE,
+        /** each thread is bound to the cores of its NUMA node (no binding on other machines) */
+        AFFINITY_NUMA,
+        /** each thread is bound to one core of its NUMA node */
+        AFFINITY_CORES
+    };
+
+    /** Set the placement of the threads shared by the Dispatcher instances (AFFINITY_NUMA by default).
+     * The threads already created apply it before their next command.
+     * \param[in] affinity : placement of the threads. */
+    static void setAffinity (Affinity affinity);
+
     /** \copydoc IDispatcher::dispatchCommands */
     size_t dispatchCommands (std::vector<ICommand*>& commands, ICommand* postTreatment=0);
 
@@ -119,12 +141,6 @@ private:
     /** */
     system::ISynchronizer* newSynchro ();
 
-    /** */
-    system::IThread* newThread (ICommand* command);
-
-    /** */
-    static void* mainloop (void* data);
-
     /** Number of execution units to be used for command dispatching. */
     size_t _nbUnits;
 
@@ -259,6 +259,13 @@ public:
      */
     friend u_int64_t hash1        (const IntegerTemplate& a,  u_int64_t seed)  {  return  boost::apply_visitor (Integer_hash1(seed),  *a);          }
 
+    /** Get a wyhash value on 64 bits for a given IntegerTemplate object (see NativeInt64::wyhash64).
+     * \param[in] a : the integer value
+     * \param[in] seed : some seed value used for the hash computation.
+     * \return the hash value on 64 bits.
+     */
+    friend u_int64_t wyhash       (const IntegerTemplate& a,  u_int64_t seed)  {  return  boost::apply_visitor (Integer_wyhash(seed),  *a);         }
+
     /** Get a hash value on 64 bits for a given IntegerTemplate object.
      * \param[in] a : the integer value
      * \return the hash value on 64 bits.
@@ -412,6 +419,10 @@ private:
         Integer_hash1 (const u_int64_t& c) : Visitor<u_int64_t,u_int64_t>(c) {}
         template<typename T>  u_int64_t operator() (const T& a) const  { return (hash1(a,this->arg));  }};
 
+    struct Integer_wyhash : public Visitor<u_int64_t,u_int64_t>    {
+        Integer_wyhash (const u_int64_t& c) : Visitor<u_int64_t,u_int64_t>(c) {}
+        template<typename T>  u_int64_t operator() (const T& a) const  { return (wyhash(a,this->arg));  }};
+
     struct Integer_oahash : public boost::static_visitor<u_int64_t>    {
         template<typename T>  u_int64_t operator() (const T& a) const  { return (oahash(a));  }};
 
@@ -0,0 +1,191 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include <gatb/tools/math/Kernels.hpp>
+#include <gatb/system/impl/System.hpp>
+
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GATB_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+using namespace gatb::core::system;
+
+/********************************************************************************/
+namespace gatb  {  namespace core  {  namespace tools  {  namespace math  {
+/********************************************************************************/
+
+/** The bodies are always inlined, so that each implementation below gets them compiled
+ * with its own instruction set. */
+#define KERNEL_INLINE  static inline __attribute__((always_inline))
+
+/********************************************************************************/
+KERNEL_INLINE u_int64_t popcountBody (const u_int8_t* data, size_t size)
+{
+    u_int64_t result = 0;
+    size_t i = 0;
+    for ( ; i+8 <= size; i+=8)  {  u_int64_t w;  memcpy (&w, data+i, 8);  result += __builtin_popcountll (w);  }
+    for ( ; i<size; i++)        {  result += __builtin_popcount (data[i]);  }
+    return result;
+}
+
+/********************************************************************************/
+KERNEL_INLINE void mmerTableBody (u_int64_t first, size_t nb, size_t m, bool canonical, bool filterAA, u_int64_t defaultValue, u_int64_t* table)
+{
+    for (size_t i=0; i<nb; i++)
+    {
+        u_int64_t x = first + i;
+        if (canonical)
+        {
+            u_int64_t r = NativeInt64::revcomp64 (x, m);
+            if (r < x)  { x = r; }
+        }
+        table[i] = filterAA && !isAllowedMmer (x, m) ? defaultValue : x;
+    }
+}
+
+/********************************************************************************/
+static u_int64_t popcountPortable (const u_int8_t* data, size_t size)  {  return popcountBody (data, size);  }
+
+static void mmerTablePortable (u_int64_t first, size_t nb, size_t m, bool canonical, bool filterAA, u_int64_t defaultValue, u_int64_t* table)
+{
+    mmerTableBody (first, nb, m, canonical, filterAA, defaultValue, table);
+}
+
+#ifdef GATB_KERNELS_X86
+
+/********************************************************************************/
+__attribute__((target("popcnt")))
+static u_int64_t popcountPopcnt (const u_int8_t* data, size_t size)  {  return popcountBody (data, size);  }
+
+/********************************************************************************/
+/** Popcount of 32 bytes at once: the counts of the nibbles are looked up with a shuffle,
+ * then summed by groups of 8 bytes with psadbw (W. Mula's method). */
+__attribute__((target("avx2,popcnt")))
+static u_int64_t popcountAvx2 (const u_int8_t* data, size_t size)
+{
+    const __m256i lookup = _mm256_setr_epi8 (0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4, 0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+    const __m256i low    = _mm256_set1_epi8 (0x0f);
+
+    __m256i acc = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for ( ; i+32 <= size; i+=32)
+    {
+        __m256i v   = _mm256_loadu_si256 ((const __m256i*) (data+i));
+        __m256i cnt = _mm256_add_epi8 (
+            _mm256_shuffle_epi8 (lookup, _mm256_and_si256 (v, low)),
+            _mm256_shuffle_epi8 (lookup, _mm256_and_si256 (_mm256_srli_epi16 (v, 4), low))
+        );
+        acc = _mm256_add_epi64 (acc, _mm256_sad_epu8 (cnt, _mm256_setzero_si256()));
+    }
+
+    u_int64_t result = _mm256_extract_epi64 (acc, 0) + _mm256_extract_epi64 (acc, 1)
+                     + _mm256_extract_epi64 (acc, 2) + _mm256_extract_epi64 (acc, 3);
+
+    return result + popcountBody (data+i, size-i);
+}
+
+/********************************************************************************/
+/** Four mmers at once; the reverse complement is the one of NativeInt64::revcomp64, with
+ * the byte swap done by a shuffle. */
+__attribute__((target("avx2")))
+static void mmerTableAvx2 (u_int64_t first, size_t nb, size_t m, bool canonical, bool filterAA, u_int64_t defaultValue, u_int64_t* table)
+{
+    const __m256i bswap   = _mm256_setr_epi8 (7,6,5,4,3,2,1,0, 15,14,13,12,11,10,9,8, 7,6,5,4,3,2,1,0, 15,14,13,12,11,10,9,8);
+    const __m256i cmpl   = _mm256_set1_epi64x (0xAAAAAAAAAAAAAAAALL);
+    const __m256i mask4   = _mm256_set1_epi64x (0x0F0F0F0F0F0F0F0FLL);
+    const __m256i mask2   = _mm256_set1_epi64x (0x3333333333333333LL);
+    const __m256i sign    = _mm256_set1_epi64x ((long long) 0x8000000000000000ULL);
+    const __m256i aaMask  = _mm256_set1_epi64x ((long long) (0x5555555555555555ULL & (((u_int64_t)1 << (2*(m-2))) - 1)));
+    const __m256i defVal  = _mm256_set1_epi64x ((long long) defaultValue);
+    const __m256i ones    = _mm256_set1_epi64x (-1);
+    const __m256i zero    = _mm256_setzero_si256 ();
+    const __m256i four    = _mm256_set1_epi64x (4);
+    const __m128i shift   = _mm_cvtsi32_si128 (2*(32-m));
+
+    __m256i x = _mm256_add_epi64 (_mm256_set1_epi64x ((long long) first), _mm256_setr_epi64x (0,1,2,3));
+
+    size_t i = 0;
+    for ( ; i+4 <= nb; i+=4, x = _mm256_add_epi64 (x, four))
+    {
+        __m256i v = x;
+
+        if (canonical)
+        {
+            __m256i r = _mm256_shuffle_epi8 (_mm256_xor_si256 (x, cmpl), bswap);
+            r = _mm256_or_si256 (_mm256_and_si256 (_mm256_srli_epi64 (r, 4), mask4), _mm256_slli_epi64 (_mm256_and_si256 (r, mask4), 4));
+            r = _mm256_or_si256 (_mm256_and_si256 (_mm256_srli_epi64 (r, 2), mask2), _mm256_slli_epi64 (_mm256_and_si256 (r, mask2), 2));
+            r = _mm256_srl_epi64 (r, shift);
+
+            /** Unsigned comparison through the signed one. */
+            __m256i rLower = _mm256_cmpgt_epi64 (_mm256_xor_si256 (x, sign), _mm256_xor_si256 (r, sign));
+            v = _mm256_blendv_epi8 (x, r, rLower);
+        }
+
+        if (filterAA)
+        {
+            __m256i a1 = _mm256_xor_si256 (_mm256_or_si256 (v, _mm256_srli_epi64 (v, 2)), ones);
+            a1 = _mm256_and_si256 (_mm256_and_si256 (_mm256_srli_epi64 (a1, 1), a1), aaMask);
+            v  = _mm256_blendv_epi8 (defVal, v, _mm256_cmpeq_epi64 (a1, zero));
+        }
+
+        _mm256_storeu_si256 ((__m256i*) (table+i), v);
+    }
+
+    mmerTableBody (first+i, nb-i, m, canonical, filterAA, defaultValue, table+i);
+}
+
+#endif /* GATB_KERNELS_X86 */
+
+/********************************************************************************/
+Kernels::Kernels ()
+{
+    select (impl::System::info().getCpuFeatures());
+}
+
+/********************************************************************************/
+void Kernels::select (u_int32_t features)
+{
+    features &= impl::System::info().getCpuFeatures();
+
+    _features  = 0;
+    _popcount  = popcountPortable;
+    _mmerTable = mmerTablePortable;
+
+#ifdef GATB_KERNELS_X86
+    if (features & ISystemInfo::CPU_POPCNT)
+    {
+        _features |= ISystemInfo::CPU_POPCNT;
+        _popcount  = popcountPopcnt;
+    }
+    if ((features & ISystemInfo::CPU_AVX2) && (features & ISystemInfo::CPU_POPCNT))
+    {
+        _features |= ISystemInfo::CPU_AVX2;
+        _popcount  = popcountAvx2;
+        _mmerTable = mmerTableAvx2;
+    }
+#endif
+}
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
@@ -0,0 +1,119 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  INRIA
+ *   Authors: R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+/** \file Kernels.hpp
+ *  \brief Block kernels with implementations chosen at runtime from the CPU features
+ */
+
+#ifndef _GATB_CORE_TOOLS_MATH_KERNELS_HPP_
+#define _GATB_CORE_TOOLS_MATH_KERNELS_HPP_
+
+/********************************************************************************/
+
+#include <gatb/system/api/types.hpp>
+#include <gatb/system/api/ISystemInfo.hpp>
+#include <gatb/tools/math/NativeInt64.hpp>
+
+/********************************************************************************/
+namespace gatb  {
+namespace core  {
+namespace tools {
+namespace math  {
+/********************************************************************************/
+
+/** Tells whether a mmer has no 'AA' except as a prefix; minimizers are chosen among
+ * such mmers in order to skip the too frequent ones (like AAAA...).
+ * \param[in] mmer : value of the mmer
+ * \param[in] m : size of the mmer, in [2,32]
+ * \return true if the mmer is allowed. */
+inline bool isAllowedMmer (u_int64_t mmer, size_t m)
+{
+    // A C T G        00   01   10   11
+    // a nucleotide pair AA gives a 01 at its position in ~(x | x>>2) & (..>>1); the first pair is not checked
+    u_int64_t mask = 0x5555555555555555ULL & (((u_int64_t)1 << (2*(m-2))) - 1);
+    u_int64_t a1   = ~(mmer | (mmer >> 2));
+    return ((a1 >> 1) & a1 & mask) == 0;
+}
+
+/********************************************************************************/
+
+/** \brief Kernels working on blocks of data, with implementations for several instruction sets.
+ *
+ * Each kernel has a portable implementation and, on x86, implementations compiled for
+ * POPCNT or AVX2 through target attributes, so that the library is still built for the
+ * baseline architecture. The implementations are chosen once from the features of the CPU
+ * running the process (see ISystemInfo::getCpuFeatures): one binary uses what each node of
+ * a heterogeneous cluster has.
+ *
+ * Only operations on blocks are dispatched here; for operations on one kmer (limb shifts,
+ * comparisons), an indirect call would cost more than it saves, so they stay inline.
+ */
+class Kernels
+{
+public:
+
+    /** Singleton method; the implementations are selected for the CPU at first call.
+     * \return the singleton. */
+    static Kernels& singleton ()  { static Kernels instance; return instance; }
+
+    /** Select the implementations for a set of features (for tests and benchmarks).
+     * The features not supported by the CPU are ignored.
+     * \param[in] features : combination of ISystemInfo::CpuFeature flags */
+    void select (u_int32_t features);
+
+    /** Get the features used by the selected implementations.
+     * \return a combination of ISystemInfo::CpuFeature flags. */
+    u_int32_t getFeatures () const  { return _features; }
+
+    /** Number of bits set in a buffer.
+     * \param[in] data : the buffer
+     * \param[in] size : size of the buffer in bytes
+     * \return the number of bits set. */
+    u_int64_t popcount (const u_int8_t* data, size_t size) const  {  return _popcount (data, size);  }
+
+    /** Values of the minimizers table for the mmers [first, first+nb[, ie. for each mmer x:
+     *  - x, or min (x, revcomp(x)) if canonical is true;
+     *  - defaultValue if filterAA is true and the value is not allowed (see isAllowedMmer).
+     * \param[in] first : first mmer
+     * \param[in] nb : number of mmers
+     * \param[in] m : size of the mmers, in [2,32]
+     * \param[in] canonical : true for canonical mmers
+     * \param[in] filterAA : true for removing mmers with AA inside
+     * \param[in] defaultValue : value of the removed mmers
+     * \param[out] table : nb values */
+    void mmerTable (u_int64_t first, size_t nb, size_t m, bool canonical, bool filterAA, u_int64_t defaultValue, u_int64_t* table) const
+    {
+        _mmerTable (first, nb, m, canonical, filterAA, defaultValue, table);
+    }
+
+private:
+
+    Kernels ();
+
+    u_int32_t _features;
+
+    u_int64_t (*_popcount)  (const u_int8_t* data, size_t size);
+    void      (*_mmerTable) (u_int64_t first, size_t nb, size_t m, bool canonical, bool filterAA, u_int64_t defaultValue, u_int64_t* table);
+};
+
+/********************************************************************************/
+} } } } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _GATB_CORE_TOOLS_MATH_KERNELS_HPP_ */
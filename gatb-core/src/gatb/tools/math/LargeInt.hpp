@@ -706,6 +706,7 @@ private:
     template<int T>  friend LargeInt<T> revcomp (const LargeInt<T>& i, size_t sizeKmer);
     template<int T>  friend u_int64_t   hash1    (const LargeInt<T>& key, u_int64_t  seed);
     template<int T>  friend u_int64_t   hash2    (const LargeInt<T>& key, u_int64_t  seed);
+    template<int T>  friend u_int64_t   wyhash   (const LargeInt<T>& key, u_int64_t  seed);
     template<int T>  friend u_int64_t   oahash  (const LargeInt<T>& key);
     template<int T>  friend u_int64_t   simplehash16    (const LargeInt<T>& key, int  shift);
     template<int T, typename m_T>  \
@@ -721,17 +722,27 @@ private:
 /********************************************************************************/
 template<int precision>  inline LargeInt<precision> revcomp (const LargeInt<precision>& x, size_t sizeKmer)
 {
-    LargeInt<precision> res;
-    res.setVal(0);
-    unsigned char* kmerrev  = (unsigned char *) (&(res.value[0]));
-    unsigned char* kmer     = (unsigned char *) (&(x.value[0]));
+    /** The words are reversed (each one with its nucleotides), so the kmer ends up in the high bits:
+     * the result is shifted right by whole words then by the remaining bits. */
+    u_int64_t rev[precision+1];
+    for (size_t i=0; i<precision; i++)  {  rev[i] = NativeInt64::revcomp64 (x.value[precision-1-i]);  }
+    rev[precision] = 0;
+
+    size_t shift = 2*(32*precision - sizeKmer);
+    size_t words = shift / 64;
+    size_t bits  = shift % 64;
 
-    for (size_t i=0; i<8*precision; ++i)
+    LargeInt<precision> res;
+    for (size_t i=0; i<precision; i++)
     {
-        kmerrev[8*precision-1-i] = revcomp_4NT [kmer[i]];
+        u_int64_t low  = i+words   < precision ? rev[i+words]   : 0;
+        u_int64_t high = i+words+1 < precision ? rev[i+words+1] : 0;
+
+        /** (high << 64-bits) written in two steps, so that bits==0 is not a special case. */
+        res.value[i] = (low >> bits) | ((high << 1) << (63 - bits));
     }
 
-    return (res >> (2*( 32*precision - sizeKmer))  ) ;
+    return res;
 }
 
 /********************************************************************************/
@@ -770,6 +781,20 @@ template<int precision>  inline u_int64_t hash2 (const LargeInt<precision>& elem
 }
 
 
+/********************************************************************************/
+/** Unlike hash1 and hash2 (xor of the hashes of the words), the words are chained
+ * in one wyhash state, so that swapping two words changes the hash. */
+template<int precision>  inline u_int64_t wyhash (const LargeInt<precision>& elem, u_int64_t seed=0)
+{
+    u_int64_t state = seed;
+
+    for (size_t i=0;i<precision;i++)
+    {
+        state = NativeInt64::wymix64 (state, elem.value[i]);
+    }
+    return NativeInt64::wyfinal64 (state, precision);
+}
+
 /********************************************************************************/
 template<int precision>  u_int64_t oahash (const LargeInt<precision>& elem)
 {
@@ -156,6 +156,7 @@ private:
     friend LargeInt<2> revcomp (const LargeInt<2>& i,   size_t sizeKmer);
     friend u_int64_t    hash1    (const LargeInt<2>& key, u_int64_t  seed);
     friend u_int64_t    hash2    (const LargeInt<2>& key, u_int64_t  seed);
+    friend u_int64_t    wyhash   (const LargeInt<2>& key, u_int64_t  seed);
     friend u_int64_t    oahash  (const LargeInt<2>& key);
     friend u_int64_t    simplehash16    (const LargeInt<2>& key, int  shift);
     template<typename m_T> friend void fastLexiMinimizer (const LargeInt<2>& x, const unsigned int _nbMinimizers, \
@@ -172,27 +173,13 @@ inline LargeInt<2> revcomp (const LargeInt<2>& in, size_t sizeKmer)
     //
     // ex:            [         AC  | .......TG   ]
     //
-    //revcomp:        [         CA  | .......GT   ]
-    //                 \_low_nucl__/\high_nucl/
+    // reversed words: [ ...GT......|  CA .........]  then shifted right to remove the unused nucleotides
 
     const __uint128_t& x = in.value;
 
-    u_int64_t high_nucl = (u_int64_t)(x>>64);
-    int nb_high_nucl = sizeKmer>32?sizeKmer - 32:0;
-
-    u_int64_t revcomp_high_nucl = NativeInt64::revcomp64 (high_nucl, nb_high_nucl);
-
-    if (sizeKmer<=32) revcomp_high_nucl = 0; // srsly dunno why this is needed. gcc bug? u_int64_t x ---> (x>>64) != 0
-
-    u_int64_t low_nucl = (u_int64_t)(x&((((__uint128_t)1)<<64)-1));
-    int nb_low_nucl = sizeKmer>32?32:sizeKmer;
-
-    u_int64_t revcomp_low_nucl = NativeInt64::revcomp64 (low_nucl, nb_low_nucl);
-
     LargeInt<2> res;
-    res.setVal(revcomp_low_nucl);
-    res <<= 2* nb_high_nucl;
-    res += revcomp_high_nucl;
+    res.value = ((__uint128_t) NativeInt64::revcomp64 ((u_int64_t) x) << 64) | NativeInt64::revcomp64 ((u_int64_t) (x >> 64));
+    res.value >>= 2*(64 - sizeKmer);
     return res;
 }
 
@@ -233,6 +220,16 @@ inline u_int64_t hash2 (const LargeInt<2>& item, u_int64_t seed=0)
 }
 
 
+/********************************************************************************/
+inline u_int64_t wyhash (const LargeInt<2>& item, u_int64_t seed=0)
+{
+    const __uint128_t& elem = item.value;
+
+    u_int64_t state = NativeInt64::wymix64 (seed,  (u_int64_t) elem);
+    state           = NativeInt64::wymix64 (state, (u_int64_t)(elem>>64));
+    return NativeInt64::wyfinal64 (state, 2);
+}
+
 /********************************************************************************/
 inline u_int64_t oahash (const LargeInt<2>& item)
 {
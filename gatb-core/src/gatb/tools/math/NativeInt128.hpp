@@ -157,6 +157,7 @@ private:
 
     friend NativeInt128 revcomp (const NativeInt128& i,   size_t sizeKmer);
     friend u_int64_t    hash1    (const NativeInt128& key, u_int64_t  seed);
+    friend u_int64_t    wyhash   (const NativeInt128& key, u_int64_t  seed);
     friend u_int64_t    oahash  (const NativeInt128& key);
     friend u_int64_t    simplehash16    (const NativeInt128& key, int  shift);
 
@@ -170,24 +171,13 @@ inline NativeInt128 revcomp (const NativeInt128& in, size_t sizeKmer)
     //
     // ex:            [         AC  | .......TG   ]
     //
-    //revcomp:        [         CA  | .......GT   ]
-    //                 \_low_nucl__/\high_nucl/
+    // reversed words: [ ...GT......|  CA .........]  then shifted right to remove the unused nucleotides
 
     const __uint128_t& x = in.value[0];
 
-    u_int64_t high_nucl = (u_int64_t)(x>>64);
-    int nb_high_nucl = sizeKmer>32?sizeKmer - 32:0;
+    __uint128_t res = ((__uint128_t) NativeInt64::revcomp64 ((u_int64_t) x) << 64) | NativeInt64::revcomp64 ((u_int64_t) (x >> 64));
 
-    __uint128_t revcomp_high_nucl = NativeInt64::revcomp64 (high_nucl, nb_high_nucl);
-
-    if (sizeKmer<=32) revcomp_high_nucl = 0; // srsly dunno why this is needed. gcc bug? u_int64_t x ---> (x>>64) != 0
-
-    u_int64_t low_nucl = (u_int64_t)(x&((((__uint128_t)1)<<64)-1));
-    int nb_low_nucl = sizeKmer>32?32:sizeKmer;
-
-    __uint128_t revcomp_low_nucl = NativeInt64::revcomp64 (low_nucl, nb_low_nucl);
-
-    return (revcomp_low_nucl<<(2*nb_high_nucl)) + revcomp_high_nucl;
+    return res >> (2*(64 - sizeKmer));
 }
 
 /********************************************************************************/
@@ -199,6 +189,16 @@ inline u_int64_t hash1 (const NativeInt128& item, u_int64_t seed=0)
            NativeInt64::hash64 ((u_int64_t)(elem&((((__uint128_t)1)<<64)-1)),seed);
 }
 
+/********************************************************************************/
+inline u_int64_t wyhash (const NativeInt128& item, u_int64_t seed=0)
+{
+    const __uint128_t& elem = item.value[0];
+
+    u_int64_t state = NativeInt64::wymix64 (seed,  (u_int64_t) elem);
+    state           = NativeInt64::wymix64 (state, (u_int64_t)(elem>>64));
+    return NativeInt64::wyfinal64 (state, 2);
+}
+
 /********************************************************************************/
 inline u_int64_t oahash (const NativeInt128& item)
 {
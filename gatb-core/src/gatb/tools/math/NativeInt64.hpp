@@ -30,6 +30,7 @@
 
 #include <iostream>
 #include <gatb/system/api/types.hpp>
+#include <gatb/system/api/config.hpp>
 #include <gatb/tools/misc/api/Abundance.hpp>
 #include <hdf5/hdf5.h>
 
@@ -143,16 +144,21 @@ public:
 
     
     /********************************************************************************/
-    inline static u_int64_t revcomp64 (const u_int64_t& x, size_t sizeKmer)
+    /** Reverse complement of the 32 nucleotides of a word. With the A=0 C=1 T=2 G=3 coding, the
+     * complement is a XOR with 2; the 2 bits groups are then reversed with a byte swap followed by
+     * a swap of the nibbles and a swap of the 2 bits groups inside each byte. */
+    inline static u_int64_t revcomp64 (const u_int64_t& x)
     {
-        u_int64_t res = x;
-
-        unsigned char* kmerrev  = (unsigned char *) (&(res));
-        unsigned char* kmer     = (unsigned char *) (&(x));
-
-        for (size_t i=0; i<8; ++i)  {  kmerrev[8-1-i] = revcomp_4NT [kmer[i]];  }
+        u_int64_t res = __builtin_bswap64 (x ^ 0xAAAAAAAAAAAAAAAAULL);
+        res = ((res >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((res & 0x0F0F0F0F0F0F0F0FULL) << 4);
+        res = ((res >> 2) & 0x3333333333333333ULL) | ((res & 0x3333333333333333ULL) << 2);
+        return res;
+    }
 
-        return (res >> (2*( 32 - sizeKmer))) ;
+    /********************************************************************************/
+    inline static u_int64_t revcomp64 (const u_int64_t& x, size_t sizeKmer)
+    {
+        return revcomp64 (x) >> (2*( 32 - sizeKmer));
     }
 
 	
@@ -203,6 +209,56 @@ public:
     }
 
 
+    /********************************************************************************/
+    /** Multiply and fold (from wyhash): the two halves of the 128 bits product are xored.
+     * \param[in] a : first operand
+     * \param[in] b : second operand
+     * \return the folded product. */
+    inline static u_int64_t mum64 (u_int64_t a, u_int64_t b)
+    {
+#if  INT128_FOUND == 1
+        __uint128_t r = (__uint128_t)a * b;
+        return (u_int64_t)r ^ (u_int64_t)(r >> 64);
+#else
+        u_int64_t ha = a >> 32, hb = b >> 32, la = (u_int32_t)a, lb = (u_int32_t)b;
+        u_int64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+        u_int64_t t  = rl + (rm0 << 32), carry = t < rl;
+        u_int64_t lo = t + (rm1 << 32);  carry += lo < t;
+        u_int64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+        return lo ^ hi;
+#endif
+    }
+
+    /********************************************************************************/
+    /** Adds a 64 bits word to a wyhash state (see wyhash functions of the integer types,
+     * which mix each word of the integer and then call wyfinal64).
+     * \param[in] state : current state (the seed for the first word)
+     * \param[in] word : word to be added
+     * \return the new state. */
+    inline static u_int64_t wymix64 (u_int64_t state, u_int64_t word)
+    {
+        return mum64 (word ^ 0xa0761d6478bd642fULL, state ^ 0xe7037ed1a0b428dbULL);
+    }
+
+    /** Final avalanche of a wyhash state.
+     * \param[in] state : state after the last word
+     * \param[in] nbWords : number of words that were mixed
+     * \return the hash value. */
+    inline static u_int64_t wyfinal64 (u_int64_t state, u_int64_t nbWords)
+    {
+        return mum64 (state ^ 0x8ebc6af09c88c6e3ULL, nbWords ^ 0x589965cc75374cc3ULL);
+    }
+
+    /** wyhash of a 64 bits word: two 64x64->128 bits multiplications, all the bits of the
+     * result depend on all the bits of the key.
+     * \param[in] key : key of the hash
+     * \param[in] seed : seed of the hash
+     * \return the hash value. */
+    inline static u_int64_t wyhash64 (u_int64_t key, u_int64_t seed)
+    {
+        return wyfinal64 (wymix64 (seed, key), 1);
+    }
+
     /********************************************************************************/
     /** computes a simple, naive hash using only 16 bits from input key
      * \param[in] key : key of the hash
@@ -231,6 +287,7 @@ private:
 
     friend NativeInt64 revcomp (const NativeInt64& i,   size_t sizeKmer);
     friend u_int64_t    hash1    (const NativeInt64& key, u_int64_t  seed);
+    friend u_int64_t    wyhash   (const NativeInt64& key, u_int64_t  seed);
     friend u_int64_t    oahash  (const NativeInt64& key);
     friend u_int64_t    simplehash16    (const NativeInt64& key, int  shift);
 
@@ -249,6 +306,12 @@ inline u_int64_t hash1 (const NativeInt64& key, u_int64_t seed=0)
     return NativeInt64::hash64 (key.value, seed);
 }
 
+/********************************************************************************/
+inline u_int64_t wyhash (const NativeInt64& key, u_int64_t seed=0)
+{
+    return NativeInt64::wyhash64 (key.value, seed);
+}
+
 /********************************************************************************/
 inline u_int64_t oahash (const NativeInt64& key)
 {
@@ -67,6 +67,10 @@ struct ArrayData
  */
 template<typename Type, typename Number=u_int16_t> struct Abundance
 {
+    /** Types of the item and of the abundance. */
+    typedef Type   ValueType;
+    typedef Number NumberType;
+
     /** Constructor.
      * \param[in] val : value of the item
      * \param[in] abund : abundance of the item.
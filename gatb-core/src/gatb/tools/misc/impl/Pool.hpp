@@ -31,6 +31,11 @@
 #include <gatb/system/impl/System.hpp>
 #include <queue>          // std::priority_queue
 
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 /********************************************************************************/
 namespace gatb      {
 namespace core      {
@@ -340,6 +345,11 @@ private:
 /********************************************************************************/
 
 //make it an allocator usable by std vector ?
+/** On NUMA machines (more than one node), the pages of the buffer are placed by first touch:
+ * the buffer is never initialized by the reserving thread, the user calls 'touch' from the
+ * thread that will work on an allocated region, and 'free_all' gives the pages back to the
+ * system so that the next round of allocations is placed again.
+ */
 class MemAllocator
 {
 public:
@@ -409,10 +419,41 @@ public:
 
     void free_all()
     {
+#ifdef __linux__
+        if (_nbNodes > 1 && used_space > 0)
+        {
+            /** The pages must be released for being placed by the threads of the next allocations. */
+            size_t pageSize = getpagesize();
+            size_t begin    = ((size_t)mainbuffer + pageSize-1) & ~(pageSize-1);
+            size_t end      = ((size_t)mainbuffer + std::min(used_space,capacity)) & ~(pageSize-1);
+            if (end > begin)  {  madvise ((void*)begin, end-begin, MADV_DONTNEED);  }
+        }
+#endif
         used_space = 0;
     }
 
-    MemAllocator(size_t nbCores=0) : mainbuffer(NULL),capacity(0),used_space(0), _nbCores(nbCores), _synchro(0)
+    /** Touch the pages of an allocated region from the calling thread, so that they are placed on
+     * its NUMA node. It does nothing (and costs nothing) on machines with a single node.
+     * Regions of several threads may share a page, so the touch is an atomic no-op write.
+     * \param[in] ptr : beginning of the region
+     * \param[in] size : size (in bytes) of the region */
+    void touch (void* ptr, u_int64_t size)
+    {
+#ifdef __linux__
+        if (_nbNodes <= 1 || size == 0)  { return; }
+
+        size_t pageSize = getpagesize();
+        char*  end      = (char*)ptr + size;
+        __sync_fetch_and_add ((char*)ptr, 0);
+        for (char* p = (char*) (((size_t)ptr + pageSize) & ~(pageSize-1)); p < end; p += pageSize)  {  __sync_fetch_and_add (p, 0);  }
+#endif
+    }
+
+    /** \return the number of NUMA nodes the allocator works for. */
+    size_t getNbNumaNodes () const  { return _nbNodes; }
+
+    MemAllocator(size_t nbCores=0) : mainbuffer(NULL),capacity(0),used_space(0), _nbCores(nbCores),
+        _nbNodes(system::impl::System::info().getNbNumaNodes()), _synchro(0)
     {
         setSynchro (system::impl::System::thread().newSynchronizer());
     }
@@ -431,6 +472,7 @@ private :
     u_int64_t used_space;
 
     size_t _nbCores;
+    size_t _nbNodes;
 
     system::ISynchronizer* _synchro;
     void setSynchro (system::ISynchronizer* synchro) { SP_SETATTR(synchro); }
@@ -131,12 +131,53 @@ public:
         return result;
     }
 
+protected:
+
+    /** Constructor for subclasses storing items in another format. */
+    CollectionFile (const std::string& filename, collections::Bag<Item>* bag, collections::Iterable<Item>* iterable)
+        : collections::impl::CollectionAbstract<Item> (bag, iterable),  _name(filename), _propertiesName(filename+".props")
+    {}
+
 private:
 
     std::string _name;
     std::string _propertiesName;
 };
 
+/********************************************************************************/
+
+/** \brief Collection of [kmer,abundance] items sorted by kmer value, stored in a file
+ * with PackedCountCodec (see BagPackedCountFile and IterablePackedCountFile).
+ */
+template <class Item> class CollectionPackedCountFile : public CollectionFile<Item>
+{
+public:
+
+    /** Constructor. */
+    CollectionPackedCountFile (const std::string& filename)
+        : CollectionFile<Item> (
+            filename,
+            new collections::impl::BagPackedCountFile<Item>(filename),
+            new collections::impl::IterablePackedCountFile<Item>(filename)
+          )
+    {}
+
+    /** Tells whether a file holds packed counts (ie. starts with the PackedCountCodec header).
+     * \param[in] filename : the file to be checked
+     * \return true if the file exists and holds packed counts. */
+    static bool isPacked (const std::string& filename)
+    {
+        if (system::impl::System::file().doesExist(filename) == false)  { return false; }
+
+        char header[collections::impl::PackedCountCodec<Item>::MAGIC_SIZE];
+        system::IFile* file = system::impl::System::file().newFile (filename, "rb");
+        bool result = file->fread (header, 1, sizeof(header)) == sizeof(header)
+                   && memcmp (header, collections::impl::PackedCountCodec<Item>::magic(), sizeof(header)) == 0;
+        delete file;
+        return result;
+    }
+};
+
 /********************************************************************************/
 /* Experimental (not documented). */
 template <class Item> class CollectionGzFile : public collections::impl::CollectionAbstract<Item>, public system::SmartPointer
@@ -39,7 +39,9 @@
 
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <stdarg.h>
+#include <zlib.h>
 #include <hdf5/hdf5.h>
 
 /********************************************************************************/
@@ -61,6 +63,11 @@ namespace impl      {
  * any more. If the datasetId is needed again, a request to get it again is needed.
  *
  * -- R: nice find, Erwan!
+ *
+ * Inserted items are buffered here until they fill a chunk of the dataset; the chunk is then
+ * filtered (shuffle/deflate) by the inserting thread and written with H5Dwrite_chunk, so the
+ * (global) HDF5 synchronizer is only held for extending the dataset and writing the chunk.
+ * Collections of distinct partitions can thus be filled concurrently by several threads.
  */
 template <class Item> struct  CollectionDataHDF5Patch : public system::SmartPointer
 {
@@ -68,7 +75,8 @@ template <class Item> struct  CollectionDataHDF5Patch : public system::SmartPoin
 
     /** */
     CollectionDataHDF5Patch (hid_t fileId, const std::string& filename, system::ISynchronizer* synchro, int compress)
-     : _fileId(fileId), _datasetId(0), _typeId(0), _nbItems(0), _name(filename), _synchro(synchro), _nbCalls(0), _compress(compress)
+     : _fileId(fileId), _datasetId(0), _typeId(0), _nbItems(0), _name(filename), _synchro(synchro), _nbCalls(0), _compress(compress),
+       _chunkSize(0), _shuffle(false), _deflate(-1), _directWrite(false), _nbCommitted(0), _nbWritten(0), _pendingSynchro(0)
     {
         /** We get the HDF5 type of the item. */
         bool isCompound=false;
@@ -79,11 +87,22 @@ template <class Item> struct  CollectionDataHDF5Patch : public system::SmartPoin
         hid_t filespaceId = H5Dget_space (this->getDatasetId());
         H5Sget_simple_extent_dims (filespaceId, &_nbItems, NULL);
         H5Sclose (filespaceId);
+
+        /** We get the chunk layout and the filters of the data set. */
+        configureChunks ();
+
+        _pendingSynchro = system::impl::System::thread().newSynchronizer();
     }
 
     /** Destructor */
     ~CollectionDataHDF5Patch ()
     {
+        /** We write the items still buffered. */
+        try  {  commit ();  }
+        catch (system::Exception& e)  {  std::cout << e.getMessage() << std::endl;  exit(1);  }
+
+        if (_pendingSynchro != 0)  { delete _pendingSynchro; }
+
         herr_t status = H5Tclose (_typeId);
         if (status < 0)  { 
             std::cout << "HDF5 error (H5Tclose), status " <<  status << std::endl; exit(1); /* used to be an exception, but recent gcc's complain when in destructor*/  }
@@ -121,6 +140,9 @@ template <class Item> struct  CollectionDataHDF5Patch : public system::SmartPoin
 
         std::string result;
 
+        /** A missing attribute gives an empty string. */
+        if (H5Aexists (getDatasetId(), key.c_str()) <= 0)  { return result; }
+
         herr_t status;
 
         hid_t datatype = H5Tcopy (H5T_C_S1);  H5Tset_size (datatype, H5T_VARIABLE);
@@ -178,7 +200,7 @@ template <class Item> struct  CollectionDataHDF5Patch : public system::SmartPoin
             hid_t dataspaceId = H5Screate_simple (1, &dims, &maxdims);
 
             /* Modify dataset creation properties, i.e. enable chunking  */
-            hsize_t chunk_dims = GATB_HDF5_NB_ITEMS_PER_BLOCK;
+            hsize_t chunk_dims = getDefaultChunkSize();
             hid_t propId = H5Pcreate     (H5P_DATASET_CREATE);
 
             if (_compress > 0)
@@ -203,6 +225,13 @@ template <class Item> struct  CollectionDataHDF5Patch : public system::SmartPoin
         return result;
     }
 
+    /** Number of items per chunk for a new data set: chunks of about GATB_HDF5_CHUNK_SIZE bytes
+     * (but not less than GATB_HDF5_NB_ITEMS_PER_BLOCK items), which fit in the HDF5 chunk cache. */
+    static hsize_t getDefaultChunkSize ()
+    {
+        return std::max ((size_t)GATB_HDF5_NB_ITEMS_PER_BLOCK, (size_t)GATB_HDF5_CHUNK_SIZE / sizeof(Item));
+    }
+
     hid_t getDatasetId ()
     {
         if (this->_datasetId == 0)  {  this->_datasetId = this->retrieveDatasetId ();  }
@@ -237,86 +266,236 @@ template <class Item> struct  CollectionDataHDF5Patch : public system::SmartPoin
         /** We periodically clean up some HDF5 resources. */
         if ( (newValue & MASK) == MASK) {  clean();  }
     }
-};
 
-/********************************************************************************/
+    hsize_t                 _chunkSize;     // number of items per chunk
+    bool                    _shuffle;       // shuffle filter set on the data set
+    int                     _deflate;       // level of the deflate filter set on the data set, -1 if none
+    bool                    _directWrite;   // chunks are filtered and written by ourself (H5Dwrite_chunk)
+    std::vector<Item>       _pending;       // items of the chunk being filled
+    hsize_t                 _nbCommitted;   // number of items of the chunks already full
+    hsize_t                 _nbWritten;     // number of items written in the data set
+    system::ISynchronizer*  _pendingSynchro;
+
+    /** Buffer items; chunks are written as soon as they are full.
+     * \param[in] items : items to be inserted.
+     * \param[in] length : number of items. */
+    void insert (const Item* items, size_t length)
+    {
+        if (items==0 || length==0)  { return; }
 
-template <class Item> class BagHDF5Patch : public collections::Bag<Item>, public system::SmartPointer
-{
-public:
+        system::LocalSynchronizer localsynchro (_pendingSynchro);
 
-    /** Constructor */
-    BagHDF5Patch (CollectionDataHDF5Patch<Item>* common)  : _common (0), _nbInserted(0)  { setCommon(common); }
+        /** The last chunk may have been written partially by a previous commit. */
+        if (_pending.empty() && _nbWritten > _nbCommitted)  {  reloadPending ();  }
 
-    /** Destructor. */
-    ~BagHDF5Patch ()  { setCommon(0); }
+        while (length > 0)
+        {
+            size_t nb = std::min ((size_t)length, (size_t)(_chunkSize - _pending.size()));
 
-    /** Insert an item into the bag.
-     * \param[in] item : the item to be inserted. */
-    void insert (const Item& item) {  insert (&item, 1);  }
+            _pending.insert (_pending.end(), items, items + nb);
+            items  += nb;
+            length -= nb;
 
-    void insert (const std::vector<Item>& items, size_t length=0)  {  insert (items.data(), length==0 ? items.size() : length); }
+            if (_pending.size() == _chunkSize)  {  writePending ();  }
+        }
+    }
 
-    /** Insert items into the bag.
-     * \param[in] items : items to be inserted. */
-    void insert (const Item* items, size_t length)
+    /** Write the buffered items, even if they don't fill a chunk, so that they can be read. */
+    void commit ()
     {
-        if (items==0 || length==0)  { return; }
-        
-        herr_t status = 0;
+        system::LocalSynchronizer localsynchro (_pendingSynchro);
+
+        writePending ();
+
+        /** We release the memory of a partial chunk; it is read back if some items are inserted later. */
+        std::vector<Item>().swap (_pending);
+    }
 
+    /** Get the chunk layout and the filters of the data set, and tell whether we can write the chunks directly,
+     * ie. the items are stored as in memory, and the filters are the ones set in retrieveDatasetId (if any). */
+    void configureChunks ()
+    {
+        hid_t propId = H5Dget_create_plist (getDatasetId());
+
+        if (H5Pget_layout (propId) == H5D_CHUNKED)
         {
-            //std::cout << "begin insert" << std::endl;
-            system::LocalSynchronizer localsynchro (_common->_synchro);
+            H5Pget_chunk (propId, 1, &_chunkSize);
 
-            /** We get the dataset id. */
-            hid_t datasetId = _common->getDatasetId();
+            hid_t fileTypeId = H5Dget_type (getDatasetId());
+            _directWrite = H5Tequal (fileTypeId, _typeId) > 0  &&  H5Tget_size (_typeId) == sizeof(Item);
+            H5Tclose (fileTypeId);
 
-            /** Resize the memory dataspace to indicate the new size of our buffer. */
-            hsize_t memDim = length;
-            hid_t memspaceId = H5Screate_simple (1, &memDim, NULL);
+            int nbFilters = H5Pget_nfilters (propId);
+            for (int i=0; i<nbFilters; i++)
+            {
+                unsigned int flags=0, values[8];
+                size_t nbValues = 8;
+                H5Z_filter_t filter = H5Pget_filter2 (propId, i, &flags, &nbValues, values, 0, NULL, NULL);
+
+                     if (filter == H5Z_FILTER_SHUFFLE && i == 0)                            { _shuffle = true;       }
+                else if (filter == H5Z_FILTER_DEFLATE && i == nbFilters-1 && nbValues > 0)  { _deflate = values[0]; }
+                else                                                                        { _directWrite = false;  }
+            }
+        }
+        else
+        {
+            _chunkSize = getDefaultChunkSize();
+        }
+
+        H5Pclose (propId);
+    }
+
+//private:
+
+    /** Write the items of the current chunk (must be called with _pendingSynchro locked). */
+    void writePending ()
+    {
+        hsize_t nbItems = _nbCommitted + _pending.size();
+        if (_pending.empty() || nbItems == _nbWritten)  { return; }
+
+        /** The chunk is prepared (and compressed) before taking the HDF5 synchronizer. */
+        std::vector<u_int8_t> chunk;
+        if (_directWrite)  {  makeChunk (chunk);  }
+
+        {
+            system::LocalSynchronizer localsynchro (_synchro);
+
+            hid_t datasetId = getDatasetId();
+            herr_t status = 0;
 
             /** Extend dataset. */
-            hsize_t newDim = _nbInserted + length;
-            status = H5Dset_extent (datasetId, &newDim);
+            status = H5Dset_extent (datasetId, &nbItems);
             if (status < 0)  { throw gatb::core::system::Exception ("HDF5 error (H5Dset_extent), status %d", status);  }
 
-            /** Select hyperslab on file dataset. */
-            hid_t filespaceId = H5Dget_space(datasetId);
-            hsize_t start = _nbInserted;
-            hsize_t count = length;
-            status = H5Sselect_hyperslab (filespaceId, H5S_SELECT_SET, &start, NULL, &count, NULL);
-            if (status < 0)  { throw gatb::core::system::Exception ("HDF5 error (H5Sselect_hyperslab), status %d", status);  }
+            hsize_t start = _nbCommitted;
+
+            if (_directWrite)
+            {
+                status = H5Dwrite_chunk (datasetId, H5P_DEFAULT, 0, &start, chunk.size(), chunk.data());
+                if (status < 0)  { throw gatb::core::system::Exception ("HDF5 error (H5Dwrite_chunk), status %d", status);  }
+
+                /** HDF5 (1.10.5) remembers the address of the last chunk looked up, and H5Dwrite_chunk leaves
+                 * there the address the chunk had before being written (ie. none for a new chunk). We look up
+                 * another chunk so that this stale address is not used by next reads (of any dataset handle). */
+                hsize_t next = start + _chunkSize;
+                hsize_t nextSize = 0;
+                H5E_BEGIN_TRY  {  H5Dget_chunk_storage_size (datasetId, &next, &nextSize);  }  H5E_END_TRY;
+            }
+            else
+            {
+                hsize_t count = _pending.size();
+                hid_t memspaceId = H5Screate_simple (1, &count, NULL);
 
-            /** Append buffer to dataset */
-            status = H5Dwrite (datasetId, _common->_typeId, memspaceId, filespaceId, H5P_DEFAULT, items);
-            if (status < 0)  { throw gatb::core::system::Exception ("HDF5 error (H5Dwrite), status %d", status);  }
+                /** Select hyperslab on file dataset. */
+                hid_t filespaceId = H5Dget_space(datasetId);
+                status = H5Sselect_hyperslab (filespaceId, H5S_SELECT_SET, &start, NULL, &count, NULL);
+                if (status < 0)  { throw gatb::core::system::Exception ("HDF5 error (H5Sselect_hyperslab), status %d", status);  }
 
-            /** We increase the number of inserted items. */
-            _nbInserted += length;
+                /** Append buffer to dataset */
+                status = H5Dwrite (datasetId, _typeId, memspaceId, filespaceId, H5P_DEFAULT, _pending.data());
+                if (status < 0)  { throw gatb::core::system::Exception ("HDF5 error (H5Dwrite), status %d", status);  }
+
+                H5Sclose (filespaceId);
+                H5Sclose (memspaceId);
+            }
+        }
 
-            __sync_fetch_and_add (&_common->_nbItems, length);
+        __sync_fetch_and_add (&_nbItems, nbItems - _nbWritten);
+        _nbWritten = nbItems;
 
-            /** Close resources. */
-            status = H5Sclose (filespaceId);
-            status = H5Sclose (memspaceId);
-            if (status != 0)  { std::cout << "err H5Sclose" << std::endl; }
-            //std::cout << "end insert" << std::endl;
+        if (_pending.size() == _chunkSize)
+        {
+            _nbCommitted += _chunkSize;
+            _pending.clear();
         }
 
         /** We periodically clean up some HDF5 resources. */
-        _common->checkCleanup ();
+        checkCleanup ();
     }
 
-    /** */
-    void flush ()  {  }
+    /** Build the chunk as HDF5 would store it: padded to the chunk size, then shuffled and deflated if needed. */
+    void makeChunk (std::vector<u_int8_t>& chunk)
+    {
+        size_t nbBytes = _chunkSize * sizeof(Item);
 
-    CollectionDataHDF5Patch<Item>* _common;
-    void setCommon (CollectionDataHDF5Patch<Item>* common)  { SP_SETATTR(common); }
+        chunk.assign (nbBytes, 0);
+        memcpy (chunk.data(), (const void*)_pending.data(), _pending.size() * sizeof(Item));
 
-private:
+        /** Same as H5Z_filter_shuffle: byte b of item i goes at position b*nbItems+i. */
+        if (_shuffle && sizeof(Item) > 1 && _chunkSize > 1)
+        {
+            std::vector<u_int8_t> shuffled (nbBytes);
+            for (size_t b=0; b<sizeof(Item); b++)
+            {
+                for (size_t i=0; i<_chunkSize; i++)  {  shuffled[b*_chunkSize + i] = chunk[i*sizeof(Item) + b];  }
+            }
+            chunk.swap (shuffled);
+        }
+
+        if (_deflate >= 0)
+        {
+            uLongf compressedSize = compressBound (nbBytes);
+            std::vector<u_int8_t> compressed (compressedSize);
+
+            if (compress2 (compressed.data(), &compressedSize, chunk.data(), nbBytes, _deflate) != Z_OK)
+            {  throw gatb::core::system::Exception ("zlib error while compressing chunk of '%s'", _name.c_str());  }
+
+            compressed.resize (compressedSize);
+            chunk.swap (compressed);
+        }
+    }
+
+    /** Read back the items of a partially written chunk (must be called with _pendingSynchro locked). */
+    void reloadPending ()
+    {
+        hsize_t start = _nbCommitted;
+        hsize_t count = _nbWritten - _nbCommitted;
+
+        _pending.resize (count);
+
+        system::LocalSynchronizer localsynchro (_synchro);
 
-    u_int64_t _nbInserted;
+        hid_t memspaceId  = H5Screate_simple (1, &count, NULL);
+        hid_t filespaceId = H5Dget_space(getDatasetId());
+
+        herr_t status = H5Sselect_hyperslab (filespaceId, H5S_SELECT_SET, &start, NULL, &count, NULL);
+        if (status < 0)  { throw gatb::core::system::Exception ("HDF5 error (H5Sselect_hyperslab), status %d", status);  }
+
+        status = H5Dread (getDatasetId(), _typeId, memspaceId, filespaceId, H5P_DEFAULT, _pending.data());
+        if (status < 0)  { throw gatb::core::system::Exception ("HDF5 error (H5Dread), status %d", status);  }
+
+        H5Sclose (filespaceId);
+        H5Sclose (memspaceId);
+    }
+};
+
+/********************************************************************************/
+
+template <class Item> class BagHDF5Patch : public collections::Bag<Item>, public system::SmartPointer
+{
+public:
+
+    /** Constructor */
+    BagHDF5Patch (CollectionDataHDF5Patch<Item>* common)  : _common (0)  { setCommon(common); }
+
+    /** Destructor. */
+    ~BagHDF5Patch ()  { setCommon(0); }
+
+    /** Insert an item into the bag.
+     * \param[in] item : the item to be inserted. */
+    void insert (const Item& item) {  insert (&item, 1);  }
+
+    void insert (const std::vector<Item>& items, size_t length=0)  {  insert (items.data(), length==0 ? items.size() : length); }
+
+    /** Insert items into the bag; they are written by chunks of the data set (see CollectionDataHDF5Patch).
+     * \param[in] items : items to be inserted. */
+    void insert (const Item* items, size_t length)  {  _common->insert (items, length);  }
+
+    /** Write the items not written yet. */
+    void flush ()  {  _common->commit ();  }
+
+    CollectionDataHDF5Patch<Item>* _common;
+    void setCommon (CollectionDataHDF5Patch<Item>* common)  { SP_SETATTR(common); }
 };
 
 /********************************************************************************/
@@ -334,10 +513,11 @@ public:
     ~IterableHDF5Patch ()  { setCommon(0);}
 
     /** */
-    dp::Iterator<Item>* iterator ()  {  return new HDF5IteratorPatch<Item> (this);  }
+    dp::Iterator<Item>* iterator ()  {  _common->commit();  return new HDF5IteratorPatch<Item> (this, _common->_chunkSize);  }
 
     /** */
     int64_t getNbItems ()  {  
+        _common->commit();
         return _common->_nbItems;  }
 
     /** */
@@ -355,6 +535,7 @@ public:
     size_t getItems (Item*& buffer, size_t start, size_t count)
     {
         //std::cout << "collectionHDF5Patch getItems called" << std::endl;
+        _common->commit();
         return retrieveCache (buffer, start, count);
     }
 
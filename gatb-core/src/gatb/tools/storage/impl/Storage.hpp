@@ -72,7 +72,9 @@ enum StorageMode_e
     /** Experimental. */
     STORAGE_GZFILE,
     /** Experimental. */
-    STORAGE_COMPRESSED_FILE
+    STORAGE_COMPRESSED_FILE,
+    /** Simple file, kmer counts being packed (see PackedCountCodec). */
+    STORAGE_PACKED_FILE
 };
 
 /********************************************************************************/
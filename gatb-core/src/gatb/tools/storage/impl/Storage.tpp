@@ -532,6 +532,7 @@ inline Storage* StorageFactory::create (const std::string& name, bool deleteIfEx
         case STORAGE_FILE:  return StorageFileFactory::createStorage (name, deleteIfExist, autoRemove);
         case STORAGE_GZFILE:  return StorageGzFileFactory::createStorage (name, deleteIfExist, autoRemove);
         case STORAGE_COMPRESSED_FILE:  return StorageSortedFactory::createStorage (name, deleteIfExist, autoRemove);
+        case STORAGE_PACKED_FILE:  return StoragePackedFileFactory::createStorage (name, deleteIfExist, autoRemove);
         default:            throw system::Exception ("Unknown mode in StorageFactory::createStorage");
     }
 }
@@ -546,6 +547,7 @@ inline bool StorageFactory::exists (const std::string& name)
         case STORAGE_FILE:              return StorageFileFactory::exists (name);
         case STORAGE_GZFILE:            return StorageGzFileFactory::exists (name);
         case STORAGE_COMPRESSED_FILE:   return StorageSortedFactory::exists (name);
+        case STORAGE_PACKED_FILE:       return StoragePackedFileFactory::exists (name);
         default:            throw system::Exception ("Unknown mode in StorageFactory::exists");
     }
 }
@@ -560,6 +562,7 @@ inline Group* StorageFactory::createGroup (ICell* parent, const std::string& nam
         case STORAGE_FILE:  return StorageFileFactory::createGroup (parent, name);
         case STORAGE_GZFILE:  return StorageGzFileFactory::createGroup (parent, name);
         case STORAGE_COMPRESSED_FILE:  return StorageSortedFactory::createGroup (parent, name);
+        case STORAGE_PACKED_FILE:  return StoragePackedFileFactory::createGroup (parent, name);
 
         default:            throw system::Exception ("Unknown mode in StorageFactory::createGroup");
     }
@@ -576,6 +579,7 @@ inline Partition<Type>* StorageFactory::createPartition (ICell* parent, const st
         case STORAGE_FILE:  return StorageFileFactory::createPartition<Type> (parent, name, nb);
         case STORAGE_GZFILE:  return StorageGzFileFactory::createPartition<Type> (parent, name, nb);
         case STORAGE_COMPRESSED_FILE:  return StorageSortedFactory::createPartition<Type> (parent, name, nb);
+        case STORAGE_PACKED_FILE:  return StoragePackedFileFactory::createPartition<Type> (parent, name, nb);
 
         default:            throw system::Exception ("Unknown mode in StorageFactory::createPartition");
     }
@@ -592,6 +596,7 @@ inline CollectionNode<Type>* StorageFactory::createCollection (ICell* parent, co
         case STORAGE_FILE:  return StorageFileFactory::createCollection<Type> (parent, name, synchro);
         case STORAGE_GZFILE:  return StorageGzFileFactory::createCollection<Type> (parent, name, synchro);
         case STORAGE_COMPRESSED_FILE:  return StorageSortedFactory::createCollection<Type> (parent, name, synchro);
+        case STORAGE_PACKED_FILE:  return StoragePackedFileFactory::createCollection<Type> (parent, name, synchro);
 
         default:            throw system::Exception ("Unknown mode in StorageFactory::createCollection");
     }
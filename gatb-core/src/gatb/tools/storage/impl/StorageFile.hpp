@@ -274,10 +274,11 @@ public:
      * \param[in] parent : parent of the collection to be created
      * \param[in] name : name of the collection to be created
      * \param[in] synchro : synchronizer instance if needed
+     * \param[in] packCounts : store new collections of [kmer,abundance] with PackedCountCodec
      * \return the created Collection instance.
      */
     template<typename Type>
-    static CollectionNode<Type>* createCollection (ICell* parent, const std::string& name, system::ISynchronizer* synchro)
+    static CollectionNode<Type>* createCollection (ICell* parent, const std::string& name, system::ISynchronizer* synchro, bool packCounts=false)
     {
         ICell* root = ICell::getRoot (parent);
         Storage* storage = dynamic_cast<Storage*> (root);
@@ -302,7 +303,61 @@ public:
 
 		DEBUG_STORAGE (("StorageFileFactory::createCollection  name='%s'  actualName='%s' \n", name.c_str(), actualName.c_str() ));
 
-        return new CollectionNode<Type> (storage->getFactory(), parent, name, new CollectionFile<Type>(actualName));
+        /** Existing files of counts are read according to their header, whatever the mode. */
+        collections::Collection<Type>* collection = PackedCountsSelector<Type>::create (actualName, packCounts);
+        if (collection == 0)  { collection = new CollectionFile<Type>(actualName); }
+
+        return new CollectionNode<Type> (storage->getFactory(), parent, name, collection);
+    }
+
+private:
+
+    /** Creates a CollectionPackedCountFile if Type is a [kmer,abundance] type and the file holds
+     * packed counts (or doesn't exist yet and packCounts is set); returns 0 otherwise. */
+    template<typename Type, bool packable = collections::impl::IsPackedCount<Type>::value>
+    struct PackedCountsSelector
+    {
+        static collections::Collection<Type>* create (const std::string& filename, bool packCounts)  { return 0; }
+    };
+
+    template<typename Type>
+    struct PackedCountsSelector<Type,true>
+    {
+        static collections::Collection<Type>* create (const std::string& filename, bool packCounts)
+        {
+            bool packed = system::impl::System::file().doesExist(filename) ?
+                CollectionPackedCountFile<Type>::isPacked (filename) :
+                packCounts;
+
+            return packed ? new CollectionPackedCountFile<Type>(filename) : 0;
+        }
+    };
+};
+
+/********************************************************************************/
+
+/** \brief Factory used for storage of kind STORAGE_PACKED_FILE
+ *
+ * Same as StorageFileFactory, except that collections of [kmer,abundance] items (like the
+ * solid kmers of DSK) are written with PackedCountCodec, which takes a few bytes per kmer
+ * instead of sizeof(Count). Such a storage can be read back as a STORAGE_FILE one.
+ */
+class StoragePackedFileFactory : public StorageFileFactory
+{
+public:
+
+    /** \copydoc StorageFileFactory::createStorage */
+    static Storage* createStorage (const std::string& name, bool deleteIfExist, bool autoRemove)
+    {
+        DEBUG_STORAGE (("StoragePackedFileFactory::createStorage  name='%s'\n", name.c_str()));
+        return new Storage (STORAGE_PACKED_FILE, name, autoRemove);
+    }
+
+    /** \copydoc StorageFileFactory::createCollection */
+    template<typename Type>
+    static CollectionNode<Type>* createCollection (ICell* parent, const std::string& name, system::ISynchronizer* synchro)
+    {
+        return StorageFileFactory::createCollection<Type> (parent, name, synchro, true);
     }
 };
 
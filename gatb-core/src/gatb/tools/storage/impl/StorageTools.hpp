@@ -113,11 +113,13 @@ public:
         std::stringstream ss1;  ss1 <<  bloom->getBitSize();
         std::stringstream ss2;  ss2 <<  bloom->getNbHash();
         std::stringstream ss3;  ss3 <<  kmerSize;
+        std::stringstream ss4;  ss4 <<  bloom->getHashVersion();
 
         bloomCollection->addProperty ("size",      ss1.str());
         bloomCollection->addProperty ("nb_hash",   ss2.str());
         bloomCollection->addProperty ("type",      bloom->getName());
         bloomCollection->addProperty ("kmer_size", ss3.str());
+        bloomCollection->addProperty ("hash_version", ss4.str());
         bloomCollection->flush (); // R: wasn't there before but I guess this can't hurt
     }
 
@@ -139,6 +141,10 @@ public:
             bloomArray->getProperty("kmer_size")
         );
 
+        /** Bloom filters saved without hash version use the first version of the hash functions. */
+        int hashVersion = atoi (bloomArray->getProperty("hash_version").c_str());
+        bloom->setHashVersion (hashVersion > 0 ? hashVersion : 1);
+
         if (bloomMode == 0)
         {
             /** We set the bloom with the provided array given as an iterable of NativeInt8 objects. */
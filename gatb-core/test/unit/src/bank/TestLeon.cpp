@@ -67,6 +67,8 @@ class TestLeon : public Test
     CPPUNIT_TEST_GATB(bank_checkLeon4);
     CPPUNIT_TEST_GATB(bank_checkLeon5);
     CPPUNIT_TEST_GATB(bank_checkLeon6);
+    CPPUNIT_TEST_GATB(bank_checkLeon9);
+    CPPUNIT_TEST_GATB(bank_checkLeon10);
 	
 	//removed some large files from distrib
    // CPPUNIT_TEST_GATB(bank_checkLeon7);
@@ -425,6 +427,117 @@ public:
 		IBank* leonBank = Bank::open (leonFile);
 		bank_compare_banks_equality(leonRefBank, leonBank);
 	}
+
+    /*******************************************************************************
+	 * Test Leon random access by block: compress with several blocks, then
+	 * check that iterating each block on its own gives back the whole bank.
+	 *
+	 * */
+	void bank_checkLeon9 ()
+	{
+    	// The existing reference file (contains 7 reads)
+    	std::string fastqFile = DBPATH("leon2.fastq");
+    	// The Leon file to create
+		string leonFile=fastqFile+".leon";
+
+		// STEP 1: compress the Fastq file, 2 reads per block
+    	std::vector<char*>       leon_args;
+    	std::vector<std::string> data = {
+    			"-",
+				"-c",
+				"-file", fastqFile,
+				"-lossless",
+				"-verbose","0",
+				"-kmer-size", "31",
+				"-abundance", "1",
+				"-reads", "2"
+    	};
+		for(std::vector<std::string>::iterator loop = data.begin(); loop != data.end(); ++loop){
+			leon_args.push_back(&(*loop)[0]);
+		}
+		Leon().run(leon_args.size(), &leon_args[0]);
+
+		// STEP 2: check blocks metadata
+		BankLeon leonBank (leonFile);
+
+		u_int64_t nbBlocks = leonBank.getNbBlocks();
+		CPPUNIT_ASSERT (nbBlocks == 4);
+
+		u_int64_t nbSeqInBlocks = 0;
+		for (u_int64_t b=0; b<nbBlocks; b++)  {  nbSeqInBlocks += leonBank.getNbSequencesInBlock(b);  }
+
+		u_int64_t number, totalSize, maxSize;
+		leonBank.estimate (number, totalSize, maxSize);
+		CPPUNIT_ASSERT (nbSeqInBlocks == number);
+		CPPUNIT_ASSERT (number == 7);
+
+		// STEP 3: compare the whole bank with its blocks iterated one at a time, in reverse order
+		// (we keep strings since a sequence refers to the iterator buffers)
+		std::vector<std::string> comments[4], dnas[4], quals[4];
+		for (int b=nbBlocks-1; b>=0; b--)
+		{
+			Iterator<Sequence>* itBlock = leonBank.iterator (b, 1);
+			LOCAL (itBlock);
+			for (itBlock->first(); !itBlock->isDone(); itBlock->next())
+			{
+				comments[b].push_back (itBlock->item().getComment());
+				dnas    [b].push_back (itBlock->item().toString());
+				quals   [b].push_back (itBlock->item().getQuality());
+			}
+			CPPUNIT_ASSERT (dnas[b].size() == leonBank.getNbSequencesInBlock(b));
+		}
+
+		Iterator<Sequence>* itLeon = leonBank.iterator();
+		LOCAL (itLeon);
+		size_t b = 0, i = 0;
+		for (itLeon->first(); !itLeon->isDone(); itLeon->next())
+		{
+			while (i == dnas[b].size())  {  b++;  i = 0;  }
+			CPPUNIT_ASSERT (b < nbBlocks);
+			Sequence& seq = itLeon->item();
+			CPPUNIT_ASSERT (seq.getComment().compare(comments[b][i])==0);
+			CPPUNIT_ASSERT (seq.toString().compare(dnas[b][i])==0);
+			CPPUNIT_ASSERT (seq.getQuality().compare(quals[b][i])==0);
+			i++;
+		}
+		CPPUNIT_ASSERT (b == nbBlocks-1 && i == dnas[b].size());
+	}
+
+    /*******************************************************************************
+	 * Test other args of Leon:
+	 *   -qual-coder cm (context model instead of zlib for qualities)
+	 *
+	 * LOSSLESS version
+	 * */
+	void bank_checkLeon10 ()
+	{
+    	// The existing reference file
+    	std::string fastqFile = DBPATH("leon2.fastq");
+    	// The Leon file to create
+		string leonFile=fastqFile+".leon";
+
+		// STEP 1: compress the Fastq file
+    	std::vector<char*>       leon_args;
+    	std::vector<std::string> data = {
+    			"-",
+				"-c",
+				"-file", fastqFile,
+				"-lossless",
+				"-verbose","0",
+				"-kmer-size", "31",
+				"-abundance", "1",
+				"-qual-coder", "cm"
+    	};
+		for(std::vector<std::string>::iterator loop = data.begin(); loop != data.end(); ++loop){
+			leon_args.push_back(&(*loop)[0]);
+		}
+		Leon().run(leon_args.size(), &leon_args[0]);
+
+		// STEP 2: compare reference and compressed version
+        IBank* fasBank = Bank::open (fastqFile);
+		IBank* leonBank = Bank::open (leonFile);
+		bank_compare_banks_equality(fasBank, leonBank);
+	}
 };
 
 /********************************************************************************/
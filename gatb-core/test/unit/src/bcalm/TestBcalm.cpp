@@ -64,6 +64,7 @@ class TestBcalm : public Test
     CPPUNIT_TEST_SUITE_GATB (TestBcalm);
 
         CPPUNIT_TEST_GATB (bcalm_test1); 
+        CPPUNIT_TEST_GATB (bcalm_test2); 
         CPPUNIT_TEST_SUITE_GATB_END();
 
 public:
@@ -115,6 +116,33 @@ public:
 
     }
 
+    /********************************************************************************/
+    void bcalm_test2 () // same, with the compact UF used by bglue in memory-bounded mode, this time really threaded
+    {
+        int nb_uf_elts = 3000000;
+        unionFindCompact uf(nb_uf_elts);
+
+        auto doJoins = [&uf](int start, int end)
+        {
+            for (int i = start; i < end; i++)
+                uf.union_(i,i+1);
+        };
+
+        std::thread first(doJoins,0,nb_uf_elts/3);
+        std::thread second(doJoins,nb_uf_elts/3,2*(nb_uf_elts/3));
+        std::thread third(doJoins,2*(nb_uf_elts/3),nb_uf_elts-1);
+
+        first.join();
+        second.join();
+        third.join();
+
+        uf.flatten();
+
+        // a root is always linked under a smaller one, so the class is the smallest element
+        for (int i = 0; i < nb_uf_elts; i++)
+            CPPUNIT_ASSERT (uf.mData[i] == 0);
+    }
+
 };
 
 /********************************************************************************/
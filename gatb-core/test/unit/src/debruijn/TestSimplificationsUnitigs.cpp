@@ -96,6 +96,9 @@ class TestSimplificationsUnitigs : public Test
         CPPUNIT_TEST_GATB (debruijn_simplunitigs_tip);
         CPPUNIT_TEST_GATB (debruijn_simplunitigs_bubble);
         CPPUNIT_TEST_GATB (debruijn_simplunitigs_bubble_snp);
+        CPPUNIT_TEST_GATB (debruijn_simplunitigs_ec_unitiglevel);
+        CPPUNIT_TEST_GATB (debruijn_simplunitigs_tip_unitiglevel);
+        CPPUNIT_TEST_GATB (debruijn_simplunitigs_bubble_unitiglevel);
     CPPUNIT_TEST_SUITE_GATB_END();
 
 public:
@@ -235,7 +238,10 @@ public:
         
    }
 
-    void debruijn_simplunitigs_tip ()
+    void debruijn_simplunitigs_tip ()            { debruijn_simplunitigs_tip_aux (false); }
+    void debruijn_simplunitigs_tip_unitiglevel () { debruijn_simplunitigs_tip_aux (true);  }
+
+    void debruijn_simplunitigs_tip_aux (bool unitigLevel)
     {
         size_t kmerSize = 21;
 
@@ -257,7 +263,7 @@ public:
         CPPUNIT_ASSERT (r.nbNonDeletedNodes == 6);
 
         // simplify it
-        graph.simplify(1, false); // one core, no verbose
+        if (unitigLevel)  { graph.simplifyUnitigs(1, false); } else { graph.simplify(1, false); } // one core, no verbose
 
 
         // how many nodes left? should be as many as initially. it's a negative test: graph shouldn't be simplified
@@ -274,7 +280,7 @@ public:
     /********************************************************************************/
 
 
-    void debruijn_simplunitigs_bubble_aux (const char* sequences[], int nb_seqs, const char* sol1, const char* sol2=nullptr)
+    void debruijn_simplunitigs_bubble_aux (const char* sequences[], int nb_seqs, const char* sol1, const char* sol2=nullptr, bool unitigLevel=false)
     {
         size_t kmerSize = 21;
 
@@ -288,7 +294,7 @@ public:
         CPPUNIT_ASSERT (r.nbNonDeletedNodes == 8);
 
         // simplify it
-        graph.simplify(1, false); // one core, no verbose
+        if (unitigLevel)  { graph.simplifyUnitigs(1, false); } else { graph.simplify(1, false); } // one core, no verbose
 
 
         r = debruijn_stats (graph, true,  true);
@@ -315,7 +321,10 @@ public:
         debruijn_traversal (graph, sequences[0], sol1, sol2);
     }
 
-    void debruijn_simplunitigs_bubble ()
+    void debruijn_simplunitigs_bubble ()            { debruijn_simplunitigs_bubble_lowcov (false); }
+    void debruijn_simplunitigs_bubble_unitiglevel () { debruijn_simplunitigs_bubble_lowcov (true);  }
+
+    void debruijn_simplunitigs_bubble_lowcov (bool unitigLevel)
     {
  
         const char* sequences[] =
@@ -329,7 +338,7 @@ public:
         };
         const char* sol = "CATCGATGCGAGACGCCTGTCGCGGGGAATTGTGGGGCGGACCACGCTCTGGCTAACGAGCTACCGTTTCCTTTAACCTGCCAGACGGTGACCAGGGCCGTTCGGCGTTGCATCGAGCGGTGTCGCTAGCGCAATGCGCAAGATTTTGACATTTACAAGGCAACATTGCAGCGTCCGATGGTCCGGTGGCCTCCAGATAGTGTCCAGTCGCTCTAACTGTATGGAGACCATAGGCATTTACCTTATTCTCATCGCCACGCCCCAAGATCTTTAGGACCCAGCATTCCTTTAACCACTAACATAACGCGTGTCATCTAGTTCAACAACCAAAATAACGACTCTTGCGCTCGGATGTCCGCAATGGGTTATCCCTATGTTCCGGTAATCTCTCATCTACTAAGCGCCCTAAAGGTCGTATGGTTGGAGGGCGGTTACACACCCTTAAGTACCGAACGATAGAGCACCCGTCTAGGAGGGCGTGCAGGGTCTCCCGCTAGCTAATGGTCACGGCCTCTCTGGGAAAGCTGAACAACGGATGATACCCATACTGCCACTCCAGTACCTGGGCCGCGTGTTGTACGCTGTGTATCTTGAGAGCGTTTCCAGCAGATAGAACAGGATCACATGTACAAA";
     
-        debruijn_simplunitigs_bubble_aux(sequences, ARRAY_SIZE(sequences),sol);
+        debruijn_simplunitigs_bubble_aux(sequences, ARRAY_SIZE(sequences),sol, nullptr, unitigLevel);
     }
 
     void debruijn_simplunitigs_bubble_snp()
@@ -354,7 +363,10 @@ public:
     }
  
 
-    void debruijn_simplunitigs_ec ()
+    void debruijn_simplunitigs_ec ()            { debruijn_simplunitigs_ec_aux (false); }
+    void debruijn_simplunitigs_ec_unitiglevel () { debruijn_simplunitigs_ec_aux (true);  }
+
+    void debruijn_simplunitigs_ec_aux (bool unitigLevel)
     {
         size_t kmerSize = 21;
 
@@ -392,7 +404,7 @@ public:
         CPPUNIT_ASSERT (r.nbNonDeletedNodes == 10);
 
         // simplify it
-        graph.simplify(1, false); // one core, no verbose
+        if (unitigLevel)  { graph.simplifyUnitigs(1, false); } else { graph.simplify(1, false); } // one core, no verbose
 
 
         // how many nodes left? should be as many as initially. it's a negative test: graph shouldn't be simplified
@@ -24,6 +24,7 @@
 #include <gatb/bank/api/Sequence.hpp>
 #include <gatb/bank/impl/Alphabet.hpp>
 #include <gatb/kmer/impl/Model.hpp>
+#include <gatb/kmer/impl/MinimizerOrder.hpp>
 
 #include <gatb/tools/math/LargeInt.hpp>
 #include <gatb/tools/math/Integer.hpp>
@@ -77,6 +78,8 @@ class TestKmer : public Test
         CPPUNIT_TEST_GATB (kmer_minimizer); // with ModelDirect
         CPPUNIT_TEST_GATB (kmer_minimizer2); // with ModelDirect
         CPPUNIT_TEST_GATB (kmer_minimizer3); // with ModelCanonical
+        CPPUNIT_TEST_GATB (kmer_minimizer_build);
+        CPPUNIT_TEST_GATB (kmer_minimizer_order);
         CPPUNIT_TEST_GATB (kmer_badchar);
 
     CPPUNIT_TEST_SUITE_GATB_END();
@@ -373,6 +376,180 @@ public:
         }
     }
 
+    /********************************************************************************/
+    template<size_t span, class ModelType>
+    struct kmer_minimizer_build_fct
+    {
+        typedef typename Kmer<span>::template ModelMinimizer<ModelType> ModelMinimizer;
+
+        const vector<typename ModelMinimizer::Kmer>& kmers;
+        size_t& nbKmers;
+
+        kmer_minimizer_build_fct (const vector<typename ModelMinimizer::Kmer>& kmers, size_t& nbKmers)  : kmers(kmers), nbKmers(nbKmers) {}
+
+        void operator() (const typename ModelMinimizer::Kmer& kmer, size_t idx)
+        {
+            CPPUNIT_ASSERT (idx < kmers.size());
+            CPPUNIT_ASSERT (kmer.value()    == kmers[idx].value());
+            CPPUNIT_ASSERT (kmer.isValid()  == kmers[idx].isValid());
+            CPPUNIT_ASSERT (kmer.minimizer().value() == kmers[idx].minimizer().value());
+            CPPUNIT_ASSERT (kmer.position() == kmers[idx].position());
+            nbKmers++;
+        }
+    };
+
+    /** The minimizers computed by 'build' must be the ones computed kmer by kmer by 'iterate'. */
+    template<size_t span, class ModelType>
+    void kmer_minimizer_build_aux (IBank& bank, size_t kmerSize, size_t miniSize)
+    {
+        typedef typename Kmer<span>::template ModelMinimizer<ModelType> ModelMinimizer;
+        ModelMinimizer minimizerModel (kmerSize, miniSize);
+
+        vector<typename ModelMinimizer::Kmer> kmers;
+        typename ModelMinimizer::Window       window;
+
+        size_t nbKmers = 0;
+        Iterator<Sequence>* itSeq = bank.iterator();  LOCAL (itSeq);
+
+        for (itSeq->first(); !itSeq->isDone(); itSeq->next())
+        {
+            bool built = minimizerModel.build ((*itSeq)->getData(), kmers, window);
+            CPPUNIT_ASSERT (built == ((*itSeq)->getDataSize() >= kmerSize));
+            if (!built)  { continue; }
+
+            size_t nbBefore = nbKmers;
+            minimizerModel.iterate ((*itSeq)->getData(), kmer_minimizer_build_fct<span,ModelType> (kmers, nbKmers));
+            CPPUNIT_ASSERT (nbKmers - nbBefore == kmers.size());
+        }
+        CPPUNIT_ASSERT (nbKmers > 0);
+    }
+
+    /** */
+    void kmer_minimizer_build ()
+    {
+        vector<IBank*> banks;
+        banks.push_back (new BankStrings ("ACCATGTATAATTATAAGTAGGTACCTATTTTTTTATTTTAAACTGAAATTCAATATTATATAGGCAAAGAT"
+                                          "TCCCCAGGCCCCTACACCCAATGTGGAACCGGGGTCCCGAATGAAAATGCTGCTGTTCCCTGGAGGTGTTCT",
+                                          "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA"
+                                          "ACGTNACGTACGTTTGCANNNACGATCGATCGTAGCTAGCTANCGATCGATCGATCGTTTAGCATCGACTAGCAT",
+                                          "ACGT", NULL));
+        banks.push_back (new BankRandom (500, 200));
+
+        size_t   kmerSizes[] = { 12,31, 33,63 };
+        size_t   miniSizes[] = {  5,  8, 10 };
+
+        static const size_t KSIZE_1 = KMER_SPAN(0);
+#if KSIZE_32
+#else
+        static const size_t KSIZE_2 = KMER_SPAN(1);
+#endif
+        for (size_t b=0; b<banks.size(); b++)
+        {
+            IBank* bank = banks[b];   LOCAL(bank);
+
+            for (size_t i=0; i<ARRAY_SIZE(kmerSizes); i++)
+            {
+                size_t kmerSize = kmerSizes[i];
+
+                for (size_t j=0; j<ARRAY_SIZE(miniSizes); j++)
+                {
+                    if (kmerSize < KSIZE_1)
+                    {
+                        kmer_minimizer_build_aux<KSIZE_1, Kmer<KSIZE_1>::ModelDirect>    (*bank, kmerSize, miniSizes[j]);
+                        kmer_minimizer_build_aux<KSIZE_1, Kmer<KSIZE_1>::ModelCanonical> (*bank, kmerSize, miniSizes[j]);
+                    }
+#if KSIZE_32
+#else
+                    else if (kmerSize < KSIZE_2)
+                    {
+                        kmer_minimizer_build_aux<KSIZE_2, Kmer<KSIZE_2>::ModelDirect>    (*bank, kmerSize, miniSizes[j]);
+                        kmer_minimizer_build_aux<KSIZE_2, Kmer<KSIZE_2>::ModelCanonical> (*bank, kmerSize, miniSizes[j]);
+                    }
+#endif
+                }
+            }
+        }
+    }
+
+    /** The decycling set must have one mmer per necklace and hit all the cycles of the de Bruijn
+     * graph; the minimizers chosen with a table of ranks must be the mmers of lowest rank. */
+    void kmer_minimizer_order ()
+    {
+        /** Numbers of necklaces of length m over 4 letters. */
+        u_int64_t nbNecklaces[] = { 0, 4, 10, 24, 70, 208, 700, 2344 };
+
+        for (size_t m=1; m<ARRAY_SIZE(nbNecklaces); m++)
+        {
+            u_int64_t rg = (u_int64_t)1 << (2*m);
+
+            MinimizerOrder::DecyclingSet set (m);
+
+            vector<bool> in (rg);
+            u_int64_t nb = 0;
+            for (u_int64_t x=0; x<rg; x++)  {  in[x] = set.contains (x);  nb += in[x];  }
+            CPPUNIT_ASSERT (nb == nbNecklaces[m]);
+
+            /** The graph without the set must be acyclic: we remove the nodes without predecessor until none remains. */
+            vector<size_t>    nbIn (rg, 0);
+            vector<u_int64_t> stack;
+            for (u_int64_t x=0; x<rg; x++)  {  for (u_int64_t c=0; c<4; c++)  {  u_int64_t y = ((x<<2) & (rg-1)) | c;  if (!in[x] && !in[y])  { nbIn[y]++; }  }  }
+            for (u_int64_t x=0; x<rg; x++)  {  if (!in[x] && nbIn[x]==0)  { stack.push_back (x); }  }
+
+            u_int64_t nbRemoved = 0;
+            while (!stack.empty())
+            {
+                u_int64_t x = stack.back();  stack.pop_back();  nbRemoved++;
+                for (u_int64_t c=0; c<4; c++)  {  u_int64_t y = ((x<<2) & (rg-1)) | c;  if (!in[y] && --nbIn[y]==0)  { stack.push_back (y); }  }
+            }
+            CPPUNIT_ASSERT (nbRemoved == rg - nb);
+        }
+
+        typedef Kmer<>::ModelCanonical                          ModelCanonical;
+        typedef Kmer<>::ModelMinimizer<ModelCanonical>          ModelMinimizer;
+
+        size_t kmerSize = 21;
+        size_t m        = 7;
+        u_int64_t rg    = (u_int64_t)1 << (2*m);
+
+        BankRandom bank (100, 150);
+
+        size_t types[] = { MinimizerOrder::RANDOM, MinimizerOrder::DECYCLING };
+
+        for (size_t t=0; t<ARRAY_SIZE(types); t++)
+        {
+            vector<uint32_t> ranks (rg);
+            MinimizerOrder::compute (types[t], m, ranks.data());
+
+            for (u_int64_t x=0; x+1<rg; x++)  {  CPPUNIT_ASSERT (ranks[x] < ranks[rg-1]);  }
+
+            ModelMinimizer model  (kmerSize, m, Kmer<>::ComparatorMinimizerFrequencyOrLex(), ranks.data());
+            ModelCanonical mmers  (m);
+
+            vector<ModelMinimizer::Kmer> kmers;
+            vector<ModelCanonical::Kmer> mmersOfKmer;
+
+            Iterator<Sequence>* itSeq = bank.iterator();  LOCAL (itSeq);
+            for (itSeq->first(); !itSeq->isDone(); itSeq->next())
+            {
+                model.build ((*itSeq)->getData(), kmers);
+
+                for (size_t i=0; i<kmers.size(); i++)
+                {
+                    string kmer = model.toString (kmers[i].value());
+                    Data data (kmer);
+                    mmers.build (data, mmersOfKmer);
+
+                    u_int64_t best = kmers[i].minimizer().value().getVal();
+                    for (size_t j=0; j<mmersOfKmer.size(); j++)
+                    {
+                        u_int64_t x = mmersOfKmer[j].value().getVal();
+                        CPPUNIT_ASSERT (ranks[best] < ranks[x] || (ranks[best] == ranks[x] && best <= x));
+                    }
+                }
+            }
+        }
+    }
+
     /** */
     struct kmer_minimizer2_info
     {
@@ -21,9 +21,13 @@
 #include <gatb/tools/collections/impl/BagFile.hpp>
 #include <gatb/tools/collections/impl/BagCache.hpp>
 #include <gatb/tools/collections/impl/IteratorFile.hpp>
+#include <gatb/tools/collections/impl/KWayMerge.hpp>
 
 #include <gatb/tools/misc/api/Macros.hpp>
 #include <gatb/tools/misc/api/Range.hpp>
+#include <gatb/tools/misc/api/Abundance.hpp>
+#include <gatb/tools/misc/impl/Stringify.hpp>
+#include <gatb/tools/math/NativeInt64.hpp>
 
 #include <gatb/tools/designpattern/api/ICommand.hpp>
 #include <gatb/tools/designpattern/impl/Command.hpp>
@@ -32,12 +36,17 @@
 #include <gatb/system/impl/System.hpp>
 
 #include <vector>
+#include <map>
 
 using namespace std;
 
 using namespace gatb::core::tools::collections;
 using namespace gatb::core::tools::collections::impl;
 
+using namespace gatb::core::tools::misc;
+using namespace gatb::core::tools::misc::impl;
+using namespace gatb::core::tools::math;
+
 using namespace gatb::core::tools::dp;
 using namespace gatb::core::tools::dp::impl;
 
@@ -59,6 +68,7 @@ class TestBag : public Test
 
         CPPUNIT_TEST_GATB (bag_checkFile);
         CPPUNIT_TEST_GATB (bag_checkCache);
+        CPPUNIT_TEST_GATB (bag_checkCountMerger);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -191,6 +201,62 @@ public:
             }
         }
     }
+
+    /********************************************************************************/
+    void bag_checkCountMerger_aux (size_t nbFiles, size_t nbItemsMax, size_t blockSize)
+    {
+        typedef Abundance<NativeInt64> Count;
+
+        /** We write sorted files of counts (some of them empty) and keep the expected merge. */
+        map<u_int64_t,u_int64_t> expected;
+        vector<string> filenames;
+
+        srand (nbFiles);
+        for (size_t f=0; f<nbFiles; f++)
+        {
+            filenames.push_back (System::file().getTemporaryDirectory() + Stringify::format ("/mergefile_%d", (int)f));
+
+            BagFile<Count> bag (filenames.back());
+            size_t    nbItems = f%4==3 ? 0 : rand() % nbItemsMax;
+            u_int64_t value   = rand() % 10;
+            for (size_t i=0; i<nbItems; i++, value += rand() % 3)
+            {
+                NativeInt64 v;  v.setVal (value);
+                u_int16_t abundance = 1 + rand() % 100;
+                bag.insert (Count (v, abundance));
+                expected[value] += abundance;
+            }
+            bag.flush();
+        }
+
+        /** We merge the files. */
+        map<u_int64_t,u_int64_t> result;
+        u_int64_t last = 0;
+        CountMerger<Count> merger (blockSize);
+        for (size_t f=0; f<nbFiles; f++)  {  merger.addFile (filenames[f]);  }
+        merger.merge ([&] (NativeInt64 value, u_int64_t abundance)
+        {
+            /** Values must be distinct and increasing. */
+            CPPUNIT_ASSERT (result.empty() || value.getVal() > last);
+            result[last = value.getVal()] = abundance;
+        });
+
+        CPPUNIT_ASSERT (result == expected);
+
+        for (size_t f=0; f<nbFiles; f++)  {  System::file().remove (filenames[f]);  }
+    }
+
+    /** */
+    void bag_checkCountMerger ()
+    {
+        size_t nbFilesTable[] = { 1, 2, 3, 7, 10, 33 };
+
+        for (size_t i=0; i<ARRAY_SIZE(nbFilesTable); i++)
+        {
+            bag_checkCountMerger_aux (nbFilesTable[i], 1000, 7);
+            bag_checkCountMerger_aux (nbFilesTable[i], 1000, 10000);
+        }
+    }
 };
 
 
@@ -20,6 +20,7 @@
 
 #define USE_LARGEINT_CONSTRUCTOR 1 // one of the only cases where LargeInt should be using its constructor; but got lazy to want to change the unit tests here.
 #include <gatb/tools/collections/impl/Bloom.hpp>
+#include <gatb/tools/collections/impl/HyperLogLog.hpp>
 
 #include <gatb/tools/misc/api/Macros.hpp>
 
@@ -31,6 +32,8 @@
 #include <time.h>       /* time */
 
 #include <set>
+#include <vector>
+#include <cmath>
 
 using namespace std;
 using namespace gatb::core::tools::collections;
@@ -51,6 +54,8 @@ class TestContainer : public Test
     CPPUNIT_TEST_SUITE_GATB (TestContainer);
 
         CPPUNIT_TEST_GATB (bloom_checkContains);
+        CPPUNIT_TEST_GATB (bloom_checkHashVersions);
+        CPPUNIT_TEST_GATB (hyperloglog_checkCardinality);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -132,6 +137,79 @@ public:
         bloom_checkContains_aux<LargeInt<5> > (values2, ARRAY_SIZE(values2));
         bloom_checkContains_aux<LargeInt<5> > (values3, ARRAY_SIZE(values3));
     }
+
+    /********************************************************************************/
+    template<typename Item> void bloom_checkHashVersions_aux (int version, u_int64_t size, size_t nbHash)
+    {
+        Bloom<Item> bloom (size, nbHash);
+        bloom.setHashVersion (version);
+        CPPUNIT_ASSERT (bloom.getHashVersion() == version);
+
+        size_t nbItems = 50*1000;
+
+        std::vector<Item> items (2*nbItems);
+        for (size_t i=0; i<items.size(); i++)
+        {
+            items[i].setVal (0);
+            for (size_t j=0; j<sizeof(Item)/2; j++)  {  Item x;  x.setVal (rand() & 0xFFFF);  items[i] = (items[i] << 16) + x;  }
+        }
+
+        for (size_t i=0; i<nbItems; i++)  {  bloom.insert (items[i]);  }
+
+        /** No false negatives. */
+        for (size_t i=0; i<nbItems; i++)  {  CPPUNIT_ASSERT (bloom.contains (items[i]) == true);  }
+
+        /** The false positive rate is close to the expected one: (1 - exp(-kn/m))^k */
+        size_t nbFalsePositives = 0;
+        for (size_t i=nbItems; i<items.size(); i++)  {  if (bloom.contains (items[i]))  { nbFalsePositives++; }  }
+
+        double expected = pow (1 - exp (- (double)nbHash * nbItems / size), nbHash);
+        CPPUNIT_ASSERT ((double)nbFalsePositives / nbItems < 2*expected);
+    }
+
+    /** */
+    void bloom_checkHashVersions ()
+    {
+        for (int version=1; version<=2; version++)
+        {
+            /** Sizes in power of 2 or not, since they use different code paths. */
+            bloom_checkHashVersions_aux<NativeInt64>  (version, 1<<19, 4);
+            bloom_checkHashVersions_aux<LargeInt<1> > (version, 500*1000, 4);
+            bloom_checkHashVersions_aux<LargeInt<2> > (version, 1<<19, 7);
+            bloom_checkHashVersions_aux<LargeInt<3> > (version, 500*1000, 3);
+            bloom_checkHashVersions_aux<LargeInt<4> > (version, 1<<19, 4);
+        }
+    }
+
+    /** */
+    void hyperloglog_checkCardinality ()
+    {
+        size_t nbValues[] = { 0, 1, 10, 1000, 50*1000, 1000*1000 };
+
+        for (size_t n=0; n<sizeof(nbValues)/sizeof(nbValues[0]); n++)
+        {
+            size_t nb = nbValues[n];
+
+            /** Each value is inserted twice, in two sketches of the same precision. */
+            HyperLogLog all (14), part1 (14), part2 (14);
+
+            for (size_t i=0; i<nb; i++)
+            {
+                u_int64_t h = NativeInt64::wyhash64 (i, 0);
+                all.insert (h);  all.insert (h);
+                (i%3==0 ? part1 : part2).insert (h);
+                part2.insert (h);
+            }
+
+            /** The relative standard error is 1.04/sqrt(2^14) (0.8%); small cardinalities are almost exact. */
+            double error = std::fabs ((double)all.cardinality() - nb) / std::max<size_t> (nb, 1);
+            CPPUNIT_ASSERT (error < (nb < 1000 ? 0.001 : 0.04));
+
+            /** Merging sketches gives the same result as a sketch of all the values. */
+            part1.merge (part2);
+            CPPUNIT_ASSERT (part1.cardinality() == all.cardinality());
+        }
+    }
 };
 
 /********************************************************************************/
@@ -0,0 +1,232 @@
+/*****************************************************************************
+ *   GATB : Genome Assembly Tool Box
+ *   Copyright (C) 2014  R.Chikhi, G.Rizk, E.Drezen
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Affero General Public License as
+ *  published by the Free Software Foundation, either version 3 of the
+ *  License, or (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Affero General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Affero General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+
+#include <CppunitCommon.hpp>
+
+#include <gatb/tools/designpattern/impl/Command.hpp>
+#include <gatb/tools/misc/api/Range.hpp>
+
+#include <vector>
+#include <unistd.h>
+
+using namespace std;
+
+using namespace gatb::core::system;
+using namespace gatb::core::system::impl;
+using namespace gatb::core::tools::dp;
+using namespace gatb::core::tools::dp::impl;
+using namespace gatb::core::tools::misc;
+
+/********************************************************************************/
+namespace gatb  {  namespace tests  {
+/********************************************************************************/
+
+/** \brief Test class for the commands dispatching
+ */
+class TestDispatcher : public Test
+{
+    /********************************************************************************/
+    CPPUNIT_TEST_SUITE_GATB (TestDispatcher);
+
+        CPPUNIT_TEST_GATB (dispatcher_checkConcurrent);
+        CPPUNIT_TEST_GATB (dispatcher_checkNested);
+        CPPUNIT_TEST_GATB (dispatcher_checkException);
+        CPPUNIT_TEST_GATB (dispatcher_checkThreadInfo);
+        CPPUNIT_TEST_GATB (dispatcher_checkAffinity);
+
+    CPPUNIT_TEST_SUITE_GATB_END();
+
+public:
+    /********************************************************************************/
+    void setUp    ()  {}
+    void tearDown ()  {}
+
+    /********************************************************************************/
+    /** Command waiting for all the commands of its dispatch to be started. */
+    class BarrierCommand : public ICommand, public SmartPointer
+    {
+    public:
+        BarrierCommand (size_t& counter, size_t nb) : _counter(counter), _nb(nb)  {}
+        void execute ()
+        {
+            __sync_fetch_and_add (&_counter, 1);
+            while (__sync_fetch_and_add (&_counter, 0) < _nb)  {  usleep (100);  }
+        }
+    private:
+        size_t& _counter;
+        size_t  _nb;
+    };
+
+    /** \brief check that the commands of a dispatch run concurrently, whatever the number of cores
+     *
+     * Test of \ref gatb::core::tools::dp::impl::Dispatcher::dispatchCommands \n
+     */
+    void dispatcher_checkConcurrent ()
+    {
+        size_t nbCommands[] = { 1, 2, 7, 16 };
+
+        /** We run several times to check that the threads are reused. */
+        for (size_t loop=0; loop<3; loop++)
+        {
+            for (size_t i=0; i<sizeof(nbCommands)/sizeof(nbCommands[0]); i++)
+            {
+                size_t counter = 0;
+
+                vector<ICommand*> commands;
+                for (size_t j=0; j<nbCommands[i]; j++)  {  commands.push_back (new BarrierCommand (counter, nbCommands[i]));  }
+
+                Dispatcher().dispatchCommands (commands);
+
+                CPPUNIT_ASSERT (counter == nbCommands[i]);
+            }
+        }
+    }
+
+    /********************************************************************************/
+    /** Command dispatching other commands. */
+    class NestedCommand : public ICommand, public SmartPointer
+    {
+    public:
+        NestedCommand (size_t& sum, size_t nb) : _sum(sum), _nb(nb)  {}
+        void execute ()
+        {
+            Dispatcher(_nb).iterate (Range<size_t>::Iterator(1,_nb), [&] (size_t i)  {  __sync_fetch_and_add (&_sum, i);  }, 1);
+        }
+    private:
+        size_t& _sum;
+        size_t  _nb;
+    };
+
+    /** \brief check dispatches done from dispatched commands
+     *
+     * Test of \ref gatb::core::tools::dp::impl::Dispatcher::dispatchCommands \n
+     */
+    void dispatcher_checkNested ()
+    {
+        size_t nbOuter = 8;
+        size_t nbInner = 10;
+        size_t sum     = 0;
+
+        vector<ICommand*> commands;
+        for (size_t j=0; j<nbOuter; j++)  {  commands.push_back (new NestedCommand (sum, nbInner));  }
+
+        Dispatcher().dispatchCommands (commands);
+
+        CPPUNIT_ASSERT (sum == nbOuter * nbInner*(nbInner+1)/2);
+    }
+
+    /********************************************************************************/
+    class ThrowCommand : public ICommand, public SmartPointer
+    {
+    public:
+        void execute ()  {  throw Exception ("something wrong");  }
+    };
+
+    /** \brief check that an exception thrown by a command is forwarded to the caller
+     *
+     * Test of \ref gatb::core::tools::dp::impl::Dispatcher::dispatchCommands \n
+     */
+    void dispatcher_checkException ()
+    {
+        vector<ICommand*> commands;
+        commands.push_back (new ThrowCommand());
+        commands.push_back (new ThrowCommand());
+
+        CPPUNIT_ASSERT_THROW (Dispatcher().dispatchCommands (commands), Exception);
+
+        /** The threads must still be usable after that. */
+        dispatcher_checkNested ();
+    }
+
+    /********************************************************************************/
+    /** Command checking its thread information and its thread local object. */
+    class InfoCommand : public ICommand, public SmartPointer
+    {
+    public:
+        InfoCommand (ThreadObject<size_t>& counts, vector<size_t>& indexes, size_t idx)
+            : _counts(counts), _indexes(indexes), _idx(idx)  {}
+        void execute ()
+        {
+            std::pair<IThread*,size_t> info;
+            if (ThreadGroup::findThreadInfo (System::thread().getThreadSelf(), info))  {  _indexes[_idx] = info.second;  }
+            _counts() += _idx;
+        }
+    private:
+        ThreadObject<size_t>& _counts;
+        vector<size_t>&       _indexes;
+        size_t                _idx;
+    };
+
+    /** \brief check that a command sees its index in the dispatch and its own thread local object
+     *
+     * Test of \ref gatb::core::system::impl::ThreadGroup::findThreadInfo \n
+     * Test of \ref gatb::core::system::impl::ThreadObject \n
+     */
+    void dispatcher_checkThreadInfo ()
+    {
+        for (size_t nb=1; nb<=8; nb++)
+        {
+            ThreadObject<size_t> counts (0);
+            vector<size_t>       indexes (nb, ~0);
+
+            vector<ICommand*> commands;
+            for (size_t j=0; j<nb; j++)  {  commands.push_back (new InfoCommand (counts, indexes, j));  }
+
+            Dispatcher().dispatchCommands (commands);
+
+            for (size_t j=0; j<nb; j++)  {  CPPUNIT_ASSERT (indexes[j] == j);  }
+
+            CPPUNIT_ASSERT (counts.size() == nb);
+            size_t sum = 0;
+            counts.foreach ([&] (size_t n)  {  sum += n;  });
+            CPPUNIT_ASSERT (sum == nb*(nb-1)/2);
+        }
+    }
+
+    /********************************************************************************/
+    /** \brief check the iteration with the different placements of the threads
+     *
+     * Test of \ref gatb::core::tools::dp::impl::Dispatcher::setAffinity \n
+     */
+    void dispatcher_checkAffinity ()
+    {
+        Dispatcher::Affinity affinities[] = { Dispatcher::AFFINITY_CORES, Dispatcher::AFFINITY_NONE, Dispatcher::AFFINITY_NUMA };
+
+        size_t nbItems = 10000;
+
+        for (size_t i=0; i<sizeof(affinities)/sizeof(affinities[0]); i++)
+        {
+            Dispatcher::setAffinity (affinities[i]);
+
+            size_t sum = 0;
+            Dispatcher(4).iterate (Range<size_t>::Iterator(1,nbItems), [&] (size_t n)  {  __sync_fetch_and_add (&sum, n);  }, 100);
+
+            CPPUNIT_ASSERT (sum == nbItems*(nbItems+1)/2);
+        }
+    }
+};
+
+/********************************************************************************/
+
+CPPUNIT_TEST_SUITE_REGISTRATION      (TestDispatcher);
+CPPUNIT_TEST_SUITE_REGISTRATION_GATB (TestDispatcher);
+
+/********************************************************************************/
+} } /* end of namespaces. */
+/********************************************************************************/
@@ -22,8 +22,17 @@
 
 #include <gatb/tools/math/LargeInt.hpp>
 #include <gatb/tools/math/Integer.hpp>
+#include <gatb/tools/math/NativeInt64.hpp>
+#include <gatb/tools/math/Kernels.hpp>
+#include <gatb/system/impl/System.hpp>
+#ifdef INT128_FOUND
+#include <gatb/tools/math/NativeInt128.hpp>
+#endif
+
+#include <cstdlib>
 
 using namespace std;
+using namespace gatb::core::system;
 using namespace gatb::core::tools::math;
 
 /********************************************************************************/
@@ -38,6 +47,9 @@ class TestMath : public Test
         CPPUNIT_TEST_GATB (math_checkBasic);
         CPPUNIT_TEST_GATB (math_checkFibo);
         CPPUNIT_TEST_GATB (math_test1);
+        CPPUNIT_TEST_GATB (math_checkRevcomp);
+        CPPUNIT_TEST_GATB (math_checkWyhash);
+        CPPUNIT_TEST_GATB (math_checkKernels);
 
     CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -172,6 +184,166 @@ public:
         math_test1_template <LargeInt<4> >();
         math_test1_template <LargeInt<5> >();
     }
+
+    /********************************************************************************/
+    /** Reverse complement computed nucleotide by nucleotide (A=0, C=1, T=2, G=3). */
+    template <typename T> T math_revcompReference (const T& x, size_t sizeKmer)
+    {
+        T res;  res.setVal (0);
+        for (size_t i=0; i<sizeKmer; i++)
+        {
+            T nt;  nt.setVal (((x >> (2*i)).getVal() & 3) ^ 2);
+            res = (res << 2) + nt;
+        }
+        return res;
+    }
+
+    template <typename T> void math_checkRevcompTemplate (size_t maxKmerSize)
+    {
+        srand (0);
+
+        for (size_t sizeKmer=1; sizeKmer<=maxKmerSize; sizeKmer++)
+        {
+            for (size_t n=0; n<100; n++)
+            {
+                T x;  x.setVal (0);
+                for (size_t i=0; i<sizeKmer; i++)  {  T nt; nt.setVal (rand() & 3);  x = (x << 2) + nt;  }
+
+                T check = math_revcompReference (x, sizeKmer);
+
+                CPPUNIT_ASSERT (revcomp (x, sizeKmer) == check);
+                CPPUNIT_ASSERT (revcomp (check, sizeKmer) == x);
+            }
+        }
+    }
+
+    void math_checkRevcomp ()
+    {
+        math_checkRevcompTemplate < LargeInt<1> > (32);
+        math_checkRevcompTemplate < LargeInt<2> > (64);
+        math_checkRevcompTemplate < LargeInt<3> > (96);
+        math_checkRevcompTemplate < LargeInt<4> > (128);
+        math_checkRevcompTemplate < NativeInt64 > (32);
+#ifdef INT128_FOUND
+        math_checkRevcompTemplate < NativeInt128 > (64);
+#endif
+    }
+
+    /********************************************************************************/
+    template<typename T> void math_checkWyhashTemplate (size_t nbWords)
+    {
+        for (size_t n=0; n<1000; n++)
+        {
+            T x;  x.setVal (0);
+            for (size_t i=0; i<nbWords; i++)  {  T w;  w.setVal ((u_int64_t)rand() << 32 | rand());  x = i==0 ? w : (x << 64) + w;  }
+
+            u_int64_t h = wyhash (x, 0);
+
+            /** Another seed gives another hash. */
+            CPPUNIT_ASSERT (wyhash (x, 1) != h);
+
+            /** Each word is taken into account. */
+            for (size_t i=0; i<nbWords; i++)
+            {
+                T one;  one.setVal (1);
+                CPPUNIT_ASSERT (wyhash (x ^ (one << (64*i)), 0) != h);
+            }
+        }
+    }
+
+    /** */
+    void math_checkWyhash ()
+    {
+        srand (0);
+
+        /** Same value in different types of one word gives the same hash. */
+        for (u_int64_t v=0; v<1000; v++)
+        {
+            LargeInt<1> a;  a.setVal (v*0x9E3779B97F4A7C15ULL);
+            NativeInt64 b;  b.setVal (v*0x9E3779B97F4A7C15ULL);
+            CPPUNIT_ASSERT (wyhash (a, 3) == wyhash (b, 3));
+        }
+
+        math_checkWyhashTemplate < LargeInt<1> > (1);
+        math_checkWyhashTemplate < LargeInt<2> > (2);
+        math_checkWyhashTemplate < LargeInt<3> > (3);
+        math_checkWyhashTemplate < LargeInt<4> > (4);
+#ifdef INT128_FOUND
+        math_checkWyhashTemplate < NativeInt128 > (2);
+#endif
+    }
+
+    /********************************************************************************/
+    void math_checkKernels ()
+    {
+        srand (0);
+
+        Kernels& kernels = Kernels::singleton();
+
+        u_int32_t cpu = impl::System::info().getCpuFeatures();
+
+        /** Each implementation supported by the CPU must give the results of the scalar code. */
+        u_int32_t features[] = { 0, ISystemInfo::CPU_POPCNT, ISystemInfo::CPU_POPCNT | ISystemInfo::CPU_AVX2 };
+
+        for (size_t f=0; f<sizeof(features)/sizeof(features[0]); f++)
+        {
+            kernels.select (features[f]);
+            CPPUNIT_ASSERT (kernels.getFeatures() == (features[f] & cpu));
+
+            /** Popcount on unaligned buffers of any size. */
+            vector<u_int8_t> buffer (1000);
+            for (size_t i=0; i<buffer.size(); i++)  {  buffer[i] = rand();  }
+
+            for (size_t offset=0; offset<8; offset++)
+            {
+                for (size_t size=0; offset+size<=buffer.size(); size += 1 + size/4)
+                {
+                    u_int64_t check = 0;
+                    for (size_t i=0; i<size; i++)  {  for (u_int8_t c=buffer[offset+i]; c; c>>=1)  { check += c&1; }  }
+
+                    CPPUNIT_ASSERT (kernels.popcount (&buffer[offset], size) == check);
+                }
+            }
+
+            /** Minimizers table. */
+            for (size_t m=2; m<=12; m++)
+            {
+                u_int64_t nb = (u_int64_t)1 << (2*m);
+                u_int64_t mask = nb - 1;
+
+                vector<u_int64_t> table (nb);
+
+                for (int canonical=0; canonical<=1; canonical++)
+                {
+                    for (int filterAA=0; filterAA<=1; filterAA++)
+                    {
+                        /** Blocks of odd sizes for checking the tails of the vectorized code. */
+                        for (u_int64_t first=0; first<nb; first+=1001)
+                        {
+                            kernels.mmerTable (first, std::min<u_int64_t> (1001, nb-first), m, canonical, filterAA, mask, &table[first]);
+                        }
+
+                        for (u_int64_t x=0; x<nb; x++)
+                        {
+                            LargeInt<1> kmer;  kmer.setVal (x);
+                            u_int64_t check = x;
+                            if (canonical)  {  check = std::min (x, revcomp (kmer, m).getVal());  }
+
+                            /** An 'AA' anywhere except at the beginning makes the mmer not allowed. */
+                            if (filterAA)
+                            {
+                                for (size_t i=0; i+2<m; i++)  {  if (((check >> (2*i)) & 0xF) == 0)  { check = mask;  break; }  }
+                            }
+
+                            CPPUNIT_ASSERT (table[x] == check);
+                        }
+                    }
+                }
+            }
+        }
+
+        kernels.select (cpu);
+    }
 };
 
 /********************************************************************************/
@@ -28,6 +28,7 @@
 #include <gatb/tools/designpattern/impl/Command.hpp>
 
 #include <gatb/tools/misc/api/Macros.hpp>
+#include <gatb/tools/misc/api/Abundance.hpp>
 #include <gatb/tools/math/NativeInt64.hpp>
 #include <gatb/tools/math/LargeInt.hpp>
 
@@ -74,6 +75,8 @@ class TestStorage : public Test
 
         CPPUNIT_TEST_GATB (storage_HDF5_check_collection);
         CPPUNIT_TEST_GATB (storage_HDF5_check_partition);
+        CPPUNIT_TEST_GATB (storage_HDF5_check_chunks);
+        CPPUNIT_TEST_GATB (storage_packed_check_partition);
         
         CPPUNIT_TEST_SUITE_GATB_END();
 
@@ -350,6 +353,150 @@ public:
         collection_HDF5_check_partition_aux (values1, ARRAY_SIZE(values1), 4);
     }
 
+    /********************************************************************************/
+    template<typename T>
+    void storage_HDF5_check_chunks_aux (int compressLevel, size_t nbParts, size_t nbItems)
+    {
+        {
+            Storage* storage = StorageFactory(STORAGE_HDF5).create ("aStorage", true, false);
+            LOCAL (storage);
+
+            storage->root().setCompressLevel (compressLevel);
+
+            Partition<T>& partition = (*storage)().getPartition <T> ("foo", nbParts);
+
+            /** Each partition is filled by its own thread, with items inserted by pieces of various sizes
+             * and flushed in the middle (so that a partial chunk has to be written, then completed). */
+            Range<size_t>::Iterator it (0, nbParts-1);
+            Dispatcher(nbParts).iterate (it, [&] (size_t p)
+            {
+                vector<T> items;
+                for (size_t i=0; i<nbItems; i++)  { items.push_back (T(i*nbParts + p)); }
+
+                size_t i=0;
+                for (size_t len=1; i<nbItems; len = (len*7) % 9973 + 1)
+                {
+                    size_t nb = std::min (len, nbItems - i);
+                    partition[p].insert (items.data() + i, nb);
+                    i += nb;
+                    if (i > nbItems/2 && i-nb <= nbItems/2)  { partition[p].flush(); }
+                }
+                partition[p].flush();
+            }, 1);
+
+            storage_HDF5_check_chunks_content (partition, nbItems);
+        }
+
+        /** We check the content once the file has been closed. */
+        {
+            Storage* storage = StorageFactory(STORAGE_HDF5).create ("aStorage", false, false);
+            LOCAL (storage);
+
+            Partition<T>& partition = (*storage)().getPartition <T> ("foo");
+            CPPUNIT_ASSERT (partition.size() == nbParts);
+
+            storage_HDF5_check_chunks_content (partition, nbItems);
+
+            storage->remove ();
+        }
+    }
+
+    template<typename T>
+    void storage_HDF5_check_chunks_content (Partition<T>& partition, size_t nbItems)
+    {
+        for (size_t p=0; p<partition.size(); p++)
+        {
+            CPPUNIT_ASSERT (partition[p].getNbItems() == (int64_t)nbItems);
+
+            size_t idx=0;
+            Iterator<T>* it = partition[p].iterator();  LOCAL(it);
+            for (it->first(); !it->isDone(); it->next(), idx++)
+            {
+                CPPUNIT_ASSERT (it->item() == T(idx*partition.size() + p));
+            }
+            CPPUNIT_ASSERT (idx == nbItems);
+        }
+    }
+
+    /********************************************************************************/
+    void storage_HDF5_check_chunks ()
+    {
+        storage_HDF5_check_chunks_aux<NativeInt64> (0, 4, 100000);
+        storage_HDF5_check_chunks_aux<NativeInt64> (6, 4, 100000);
+        storage_HDF5_check_chunks_aux<NativeInt64> (6, 3, 10);
+    }
+
+    /********************************************************************************/
+    template<typename T>
+    void storage_packed_check_partition_aux ()
+    {
+        typedef Abundance<T,u_int32_t> Count;
+
+        /** We fill 4 partitions: sorted kmers, unsorted kmers, nothing, sorted kmers with big gaps. */
+        vector<Count> values[4];
+        T v = value<T> (12345);
+        for (size_t i=0; i<5000; i++)   {  v = v + value<T> (1+(i*7)%13);  values[0].push_back (Count (v, 1+i%300));  }
+        for (size_t i=0; i<5000; i++)   {  values[1].push_back (Count (value<T> ((i*7919)%5000), i));  }
+        T w = value<T> (1);
+        for (size_t i=0; i<3000; i++)   {  w = w + (w << 3) + value<T> (i);  values[3].push_back (Count (w, 70000+i));  }
+        std::sort (values[3].begin(), values[3].end(), CountLess<Count>());
+
+        {
+            Storage* storage = StorageFactory(STORAGE_PACKED_FILE).create ("packedStorage", true, false);
+            LOCAL (storage);
+
+            Partition<Count>& partition = (*storage)().getPartition<Count> ("solid", 4);
+
+            for (size_t p=0; p<4; p++)  {  partition[p].insert (values[p]);  }
+            partition.flush ();
+
+            storage_packed_check_content (partition, values);
+        }
+
+        /** Packed counts are read back by a simple file storage. */
+        {
+            Storage* storage = StorageFactory(STORAGE_FILE).create ("packedStorage", false, false);
+            LOCAL (storage);
+
+            Partition<Count>& partition = (*storage)().getPartition<Count> ("solid");
+            CPPUNIT_ASSERT (partition.size() == 4);
+
+            storage_packed_check_content (partition, values);
+
+            storage->remove ();
+        }
+    }
+
+    template<typename T>
+    static T value (u_int64_t val)  {  T result;  result.setVal (val);  return result;  }
+
+    template<typename Count>
+    struct CountLess  {  bool operator() (const Count& a, const Count& b) const  {  return a.value < b.value;  }  };
+
+    template<typename Count>
+    void storage_packed_check_content (Partition<Count>& partition, vector<Count>* values)
+    {
+        for (size_t p=0; p<4; p++)
+        {
+            CPPUNIT_ASSERT (partition[p].getNbItems() == (int64_t)values[p].size());
+
+            size_t idx=0;
+            Iterator<Count>* it = partition[p].iterator();  LOCAL(it);
+            for (it->first(); !it->isDone(); it->next(), idx++)
+            {
+                CPPUNIT_ASSERT (idx < values[p].size());
+                CPPUNIT_ASSERT (it->item() == values[p][idx]);
+            }
+            CPPUNIT_ASSERT (idx == values[p].size());
+        }
+    }
+
+    /********************************************************************************/
+    void storage_packed_check_partition ()
+    {
+        storage_packed_check_partition_aux<NativeInt64> ();
+        storage_packed_check_partition_aux<LargeInt<3> > ();
+    }
     
     template <class T>
     void storage_stream_aux(T storage)